@@ -0,0 +1,298 @@
+/** @file kernels.c
+ * @brief Control kernels measured by the QEMU Cortex-M3 benchmark
+ *
+ * The formatting, framing, black-box and ring kernels call the robot's own src/ modules. The
+ * flywheel estimator and ladder are copies of controlFlywheelSpeed() and flywheelStep(), which
+ * call into the PROS kernel and cannot be linked here; keep them in step when those change. The
+ * filter, PID and odometry kernels are integer and float versions of the same maths, so the
+ * soft-float cost on the M3 can be weighed before either goes into the robot.
+ */
+
+#include "blackbox.h"
+#include "delta.h"
+#include "flywheel.h"
+#include "fmt.h"
+#include "frame.h"
+#include "m3bench.h"
+#include "ring.h"
+#include "telemetry.h"
+
+//Inputs are read through volatile so nothing folds at compile time
+#define BENCH_INPUTS 64
+#define BENCH_MASK (BENCH_INPUTS - 1)
+
+#define BENCH_HISTORY (FLYWHEEL_WINDOW / FLYWHEEL_PERIOD)
+
+//PID gains in Q8 and their float twins
+#define PID_KP 896
+#define PID_KI 26
+#define PID_KD 256
+#define PID_INTEGRAL_MAX (127 << 8)
+
+//Odometry: metres per encoder tick and radians of heading per tick of difference
+#define ODOM_TICK 0.000887f
+#define ODOM_TURN 0.00246f
+#define ODOM_PI 3.14159265f
+//Fixed point odometry: angles in 65536ths of a turn, sines in Q14, positions in Q16 ticks
+#define ODOM_ANGLE_PER_TICK 26
+#define ODOM_TABLE 256
+
+static volatile int input[BENCH_INPUTS];
+static volatile int sink;
+static char text[FMT_INT_SIZE + 8];
+static unsigned char record[sizeof(TelemetryRecord)];
+static unsigned char frame[FRAME_SIZE(sizeof(TelemetryRecord))];
+static unsigned char ringBuffer[1024];
+static unsigned char out[DELTA_MAX_SIZE + FRAME_SIZE(sizeof(TelemetryRecord))];
+static Ring ring;
+static Delta delta;
+static int values[BLACKBOX_FIELDS];
+static int history[BENCH_HISTORY];
+static int slot;
+static int filtered;
+static int integral;
+static int lastError;
+static float integralFloat;
+static float lastErrorFloat;
+static float odomX;
+static float odomY;
+static float odomHeading;
+static int fixedX;
+static int fixedY;
+static unsigned int fixedHeading;
+static short sineTable[ODOM_TABLE + 1];
+
+static const FlywheelTarget longRange = {83, 1, 127, 51}; //flywheelLongRange
+
+//Sine on [-pi, pi] from a fifth order polynomial, as a robot without libm would write it
+static float benchSin(float x) {
+  float x2;
+
+  while(x > ODOM_PI) {
+    x -= 2 * ODOM_PI;
+  }
+  while(x < -ODOM_PI) {
+    x += 2 * ODOM_PI;
+  }
+  if(x > ODOM_PI / 2) { //Fold into [-pi/2, pi/2] where the polynomial is good
+    x = ODOM_PI - x;
+  } else if(x < -ODOM_PI / 2) {
+    x = -ODOM_PI - x;
+  }
+  x2 = x * x;
+  return x * (1 - x2 / 6 * (1 - x2 / 20 * (1 - x2 / 42)));
+}
+
+static int benchFixedSin(unsigned int angle) {
+  unsigned int index = (angle & 0xFFFF) >> 8;
+  int fraction = (int)(angle & 0xFF);
+
+  return sineTable[index] + (((sineTable[index + 1] - sineTable[index]) * fraction) >> 8);
+}
+
+static void benchSetup() {
+  unsigned int seed = 12345;
+  int i;
+
+  for(i = 0; i < BENCH_INPUTS; i++) {
+    seed = seed * 1103515245u + 12345u;
+    input[i] = (int)(seed >> 16) % 200 - 100;
+  }
+  for(i = 0; i < (int)sizeof(record); i++) {
+    record[i] = (unsigned char)input[i & BENCH_MASK];
+  }
+  for(i = 0; i <= ODOM_TABLE; i++) {
+    sineTable[i] = (short)(benchSin(2 * ODOM_PI * i / ODOM_TABLE) * 16384);
+  }
+  ringInit(&ring, ringBuffer, sizeof(ringBuffer));
+  deltaReset(&delta, BLACKBOX_FIELDS);
+}
+
+static void benchNop(unsigned int i) {
+}
+
+// -------------------- Velocity estimation --------------------
+
+static void benchVelocity(unsigned int i) {
+  int count = (int)i * 4 + input[i & BENCH_MASK];
+
+  sink = count - history[slot];
+  history[slot] = count;
+  slot = (slot + 1) % BENCH_HISTORY;
+}
+
+static void benchVelocityMask(unsigned int i) {
+  int count = (int)i * 4 + input[i & BENCH_MASK];
+
+  sink = count - history[slot];
+  history[slot] = count;
+  slot = (slot + 1) & (BENCH_HISTORY - 1); //BENCH_HISTORY is a power of two
+}
+
+static void benchLadder(unsigned int i) {
+  const FlywheelTarget *now = &longRange;
+  int speed = now->speed + input[i & BENCH_MASK] / 10;
+  int power = sink;
+
+  if(now->speed <= 0) {
+    power = 0;
+  } else if(speed > now->speed) {
+    power = now->overPower;
+  } else if(speed > now->speed - 5 && speed < now->speed) {
+    power = now->nearPower;
+  } else if(speed < now->speed) {
+    power = 127;
+  }
+  sink = power + (abs(speed - now->speed) < now->tolerance);
+}
+
+// -------------------- Filters --------------------
+
+static void benchEma(unsigned int i) {
+  //State in Q4, quarter of the way to each new sample
+  filtered += ((input[i & BENCH_MASK] << 4) - filtered) >> 2;
+  sink = filtered >> 4;
+}
+
+static void benchMedian3(unsigned int i) {
+  int a = input[i & BENCH_MASK];
+  int b = input[(i + 1) & BENCH_MASK];
+  int c = input[(i + 2) & BENCH_MASK];
+  int t;
+
+  if(a > b) {
+    t = a;
+    a = b;
+    b = t;
+  }
+  if(b > c) {
+    b = c;
+  }
+  sink = a > b ? a : b;
+}
+
+// -------------------- PID --------------------
+
+static void benchPidInt(unsigned int i) {
+  int error = input[i & BENCH_MASK];
+  int output;
+
+  integral += error * PID_KI;
+  if(integral > PID_INTEGRAL_MAX) {
+    integral = PID_INTEGRAL_MAX;
+  } else if(integral < -PID_INTEGRAL_MAX) {
+    integral = -PID_INTEGRAL_MAX;
+  }
+  output = (error * PID_KP + integral + (error - lastError) * PID_KD) >> 8;
+  lastError = error;
+  sink = output > 127 ? 127 : (output < -127 ? -127 : output);
+}
+
+static void benchPidFloat(unsigned int i) {
+  float error = (float)input[i & BENCH_MASK];
+  float output;
+
+  integralFloat += error * (PID_KI / 256.0f);
+  if(integralFloat > 127) {
+    integralFloat = 127;
+  } else if(integralFloat < -127) {
+    integralFloat = -127;
+  }
+  output = error * (PID_KP / 256.0f) + integralFloat + (error - lastErrorFloat) * (PID_KD / 256.0f);
+  lastErrorFloat = error;
+  sink = output > 127 ? 127 : (output < -127 ? -127 : (int)output);
+}
+
+// -------------------- Odometry --------------------
+
+static void benchOdomFloat(unsigned int i) {
+  int left = input[i & BENCH_MASK];
+  int right = input[(i + 7) & BENCH_MASK];
+  float distance = (left + right) * (ODOM_TICK / 2);
+
+  odomHeading += (left - right) * ODOM_TURN;
+  odomX += distance * benchSin(odomHeading + ODOM_PI / 2);
+  odomY += distance * benchSin(odomHeading);
+  sink = (int)odomX;
+}
+
+static void benchOdomFixed(unsigned int i) {
+  int left = input[i & BENCH_MASK];
+  int right = input[(i + 7) & BENCH_MASK];
+  int distance = (left + right) << 15; //Q16 ticks, halved
+
+  fixedHeading += (unsigned int)((left - right) * ODOM_ANGLE_PER_TICK);
+  fixedX += (int)(((long long)distance * benchFixedSin(fixedHeading + 0x4000)) >> 14);
+  fixedY += (int)(((long long)distance * benchFixedSin(fixedHeading)) >> 14);
+  sink = fixedX >> 16;
+}
+
+// -------------------- Formatting and logging --------------------
+
+static void benchFmtInt(unsigned int i) {
+  sink = fmtInt(text, input[i & BENCH_MASK] * 997);
+}
+
+static void benchFmtFixed(unsigned int i) {
+  sink = fmtFixed(text, input[i & BENCH_MASK] * 131, 3);
+}
+
+//The same two conversions through newlib, as display.c did them before fmt.c
+static void benchSnprintfInt(unsigned int i) {
+  sink = snprintf(text, sizeof(text), "%d", input[i & BENCH_MASK] * 997);
+}
+
+static void benchSnprintfFixed(unsigned int i) {
+  int value = input[i & BENCH_MASK] * 131;
+
+  sink = snprintf(text, sizeof(text), "%s%d.%03d", value < 0 ? "-" : "", abs(value) / 1000,
+    abs(value) % 1000);
+}
+
+static void benchCrc(unsigned int i) {
+  record[0] = (unsigned char)i;
+  sink = frameCrc(record, sizeof(record));
+}
+
+static void benchFrame(unsigned int i) {
+  record[0] = (unsigned char)i;
+  sink = (int)frameEncode(record, sizeof(record), frame);
+}
+
+static void benchDelta(unsigned int i) {
+  int field;
+
+  values[0] += BLACKBOX_PERIOD; //Time always moves; a few fields wander
+  for(field = 1; field < 4; field++) {
+    values[field] += input[(i + field) & BENCH_MASK] >> 5;
+  }
+  sink = deltaEncode(&delta, values, out);
+}
+
+static void benchRing(unsigned int i) {
+  frame[0] = (unsigned char)i;
+  ringWrite(&ring, frame, sizeof(frame));
+  sink = (int)ringRead(&ring, out, sizeof(frame));
+}
+
+const BenchKernel benchKernels[] = {
+  {"nop", benchSetup, benchNop},
+  {"velocity", benchSetup, benchVelocity},
+  {"velocity_mask", benchSetup, benchVelocityMask},
+  {"ladder", benchSetup, benchLadder},
+  {"ema", benchSetup, benchEma},
+  {"median3", benchSetup, benchMedian3},
+  {"pid_int", benchSetup, benchPidInt},
+  {"pid_float", benchSetup, benchPidFloat},
+  {"odom_float", benchSetup, benchOdomFloat},
+  {"odom_fixed", benchSetup, benchOdomFixed},
+  {"fmt_int", benchSetup, benchFmtInt},
+  {"fmt_fixed", benchSetup, benchFmtFixed},
+  {"snprintf_int", benchSetup, benchSnprintfInt},
+  {"snprintf_fixed", benchSetup, benchSnprintfFixed},
+  {"crc_record", benchSetup, benchCrc},
+  {"frame_record", benchSetup, benchFrame},
+  {"delta_blackbox", benchSetup, benchDelta},
+  {"ring_record", benchSetup, benchRing},
+  {NULL, NULL, NULL}
+};
@@ -0,0 +1,75 @@
+/** @file m3bench.c
+ * @brief Driver for the QEMU Cortex-M3 microbenchmark image
+ *
+ * Command line (from -semihosting-config arg=...): "m3bench KERNEL CALLS" runs setup() then
+ * CALLS calls of the named kernel and exits; "m3bench list" prints the kernel names. The
+ * image measures nothing itself: m3bench.sh runs it under QEMU's instruction counting plugin
+ * with CALLS and with 0 calls, and the difference over CALLS is the cost per call.
+ */
+
+#include <string.h>
+
+#include "m3bench.h"
+
+#define BENCH_LINE 128
+
+static unsigned int benchParse(const char *text) {
+  unsigned int value = 0;
+
+  while(*text >= '0' && *text <= '9') {
+    value = value * 10 + (unsigned int)(*text++ - '0');
+  }
+  return value;
+}
+
+int main() {
+  char line[BENCH_LINE];
+  char *words[3];
+  char *p = line;
+  const BenchKernel *kernel;
+  unsigned int calls;
+  unsigned int i;
+  int count = 0;
+
+  if(benchCommandLine(line, sizeof(line)) < 0) {
+    benchPrint("m3bench: no command line\n");
+    return 2;
+  }
+  while(count < 3 && *p) { //Split on spaces in place
+    while(*p == ' ') {
+      *p++ = '\0';
+    }
+    if(*p) {
+      words[count++] = p;
+    }
+    while(*p && *p != ' ') {
+      p++;
+    }
+  }
+
+  if(count == 2 && strcmp(words[1], "list") == 0) {
+    for(kernel = benchKernels; kernel->name; kernel++) {
+      benchPrint(kernel->name);
+      benchPrint("\n");
+    }
+    return 0;
+  }
+  if(count < 3) {
+    benchPrint("usage: m3bench KERNEL CALLS | list\n");
+    return 2;
+  }
+  for(kernel = benchKernels; kernel->name && strcmp(kernel->name, words[1]) != 0; kernel++);
+  if(!kernel->name) {
+    benchPrint("m3bench: no such kernel\n");
+    return 2;
+  }
+
+  calls = benchParse(words[2]);
+  if(kernel->setup) {
+    kernel->setup();
+  }
+  for(i = 0; i < calls; i++) {
+    kernel->run(i);
+  }
+  return 0;
+}
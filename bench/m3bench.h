@@ -0,0 +1,50 @@
+/** @file m3bench.h
+ * @brief Header file for the QEMU Cortex-M3 microbenchmark image
+ *
+ * The image runs bare on QEMU's lm3s6965evb board and talks to the host only through ARM
+ * semihosting, so it needs no UART driver and no PROS kernel.
+ */
+
+#ifndef M3BENCH_H_
+
+#define M3BENCH_H_
+
+#include <stdint.h>
+
+/**
+ * A kernel under test. run() is called once per measured call with the call number, so it can
+ * vary its inputs; setup() runs once before the first call and is not measured.
+ */
+typedef struct {
+  const char *name;
+  void (*setup)();
+  void (*run)(unsigned int i);
+} BenchKernel;
+
+/**
+ * Every kernel, ending with a NULL name.
+ */
+extern const BenchKernel benchKernels[];
+
+/**
+ * Prints a string to the host.
+ *
+ * @param text the NUL-terminated string
+ */
+void benchPrint(const char *text);
+/**
+ * Reads the command line QEMU was given with -semihosting-config arg=...
+ *
+ * @param buffer where to store the line
+ * @param size the buffer size
+ * @return the line length, or -1 if there is none
+ */
+int benchCommandLine(char *buffer, int size);
+/**
+ * Stops QEMU with an exit status.
+ *
+ * @param status 0 for success
+ */
+void benchExit(int status) __attribute__((noreturn));
+
+#endif
@@ -0,0 +1,56 @@
+#!/bin/sh
+# Runs every kernel of the m3bench image under QEMU and prints instructions per call
+#
+# Usage: m3bench.sh ELF PLUGIN [CALLS]
+#   ELF     the image built by bench/Makefile
+#   PLUGIN  QEMU's libinsn.so instruction counting plugin
+#   CALLS   calls per measurement, 1000 by default
+#
+# Each kernel is run with CALLS calls and with none; the difference over CALLS is the cost of
+# one call including the driver loop, and the nop kernel's cost is taken off that. QEMU counts
+# retired instructions, not cycles: on the M3 loads, branches and soft-float calls cost more
+# than one cycle each, so compare kernels that do the same job, not absolute figures.
+
+ELF=$1
+PLUGIN=$2
+CALLS=${3:-1000}
+QEMU=${QEMU:-qemu-system-arm}
+
+if [ -z "$ELF" ] || [ -z "$PLUGIN" ]; then
+	echo "usage: m3bench.sh ELF PLUGIN [CALLS]" >&2
+	exit 2
+fi
+LOG=$(mktemp)
+trap 'rm -f "$LOG"' EXIT
+
+# run KERNEL CALLS: prints QEMU's console output, leaves the plugin log in $LOG
+run() {
+	rm -f "$LOG"
+	"$QEMU" -M lm3s6965evb -cpu cortex-m3 -display none -monitor none -serial none \
+		-chardev stdio,id=con \
+		-semihosting-config enable=on,target=native,chardev=con,arg=m3bench,arg=$1,arg=$2 \
+		-kernel "$ELF" -plugin "$PLUGIN",inline=on -d plugin -D "$LOG"
+}
+
+# count KERNEL CALLS: prints the instructions the run retired
+count() {
+	run "$1" "$2" > /dev/null || { echo "m3bench: $1 failed" >&2; exit 1; }
+	awk '/insns:/ { n = $NF } END { print n + 0 }' "$LOG"
+}
+
+# perCall KERNEL: prints the instructions per call, before taking off the nop kernel
+perCall() {
+	full=$(count "$1" "$CALLS") || exit 1
+	empty=$(count "$1" 0) || exit 1
+	awk -v a="$full" -v b="$empty" -v n="$CALLS" 'BEGIN { printf "%.1f\n", (a - b) / n }'
+}
+
+KERNELS=$(run list 0) || { echo "m3bench: cannot list kernels" >&2; exit 1; }
+NOP=$(perCall nop) || exit 1
+printf "%-16s %12s\n" kernel insns/call
+for k in $KERNELS; do
+	[ "$k" = nop ] && continue
+	cost=$(perCall "$k") || exit 1
+	awk -v k="$k" -v c="$cost" -v z="$NOP" 'BEGIN { printf "%-16s %12.1f\n", k, c - z }'
+done
+echo "(call overhead of $NOP instructions removed, $CALLS calls per kernel)"
@@ -0,0 +1,74 @@
+/** @file startup.c
+ * @brief Bare-metal startup and semihosting calls for the QEMU Cortex-M3 benchmark
+ */
+
+#include "m3bench.h"
+
+//Semihosting operations
+#define SYS_WRITE0 0x04
+#define SYS_GET_CMDLINE 0x15
+#define SYS_EXIT_EXTENDED 0x20
+#define ADP_STOPPED_APPLICATION_EXIT 0x20026
+
+//From m3bench.ld
+extern uint32_t _sidata;
+extern uint32_t _sdata;
+extern uint32_t _edata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+extern uint32_t _estack;
+
+int main();
+
+static int benchSemihost(int operation, const void *argument) {
+  register int r0 __asm__("r0") = operation;
+  register const void *r1 __asm__("r1") = argument;
+
+  __asm__ volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+  return r0;
+}
+
+void benchPrint(const char *text) {
+  benchSemihost(SYS_WRITE0, text);
+}
+
+int benchCommandLine(char *buffer, int size) {
+  uintptr_t block[2] = {(uintptr_t)buffer, (uintptr_t)size};
+
+  if(benchSemihost(SYS_GET_CMDLINE, block) != 0) {
+    return -1;
+  }
+  return (int)block[1];
+}
+
+void benchExit(int status) {
+  uint32_t block[2] = {ADP_STOPPED_APPLICATION_EXIT, (uint32_t)status};
+
+  benchSemihost(SYS_EXIT_EXTENDED, block);
+  while(1);
+}
+
+void benchReset() {
+  uint32_t *from = &_sidata;
+  uint32_t *to;
+
+  for(to = &_sdata; to < &_edata;) {
+    *to++ = *from++;
+  }
+  for(to = &_sbss; to < &_ebss;) {
+    *to++ = 0;
+  }
+  benchExit(main());
+}
+
+static void benchFault() {
+  benchPrint("m3bench: fault\n");
+  benchExit(3);
+}
+
+//Initial stack, reset, then NMI to SysTick all fault out; no peripheral interrupts are used
+__attribute__((section(".isr_vector"), used))
+static void (*const vectors[16])() = {
+  (void (*)())&_estack, benchReset, benchFault, benchFault, benchFault, benchFault,
+  benchFault, 0, 0, 0, 0, benchFault, benchFault, 0, benchFault, benchFault
+};
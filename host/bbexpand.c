@@ -0,0 +1,126 @@
+/** @file bbexpand.c
+ * @brief Host tool that expands black-box files into CSV
+ *
+ * Accepts the files copied off the Cortex, or a blackboxDump() capture holding several files
+ * back to back, and writes one CSV row per sample to stdout with the session it came from.
+ *
+ * Usage: bbexpand [bb0 bb1 ... | dump.bin] > match.csv
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blackbox.h"
+#include "delta.h"
+
+static const char *fieldNames[BLACKBOX_FIELDS] = {
+  "time_ms", "speed", "flywheel", "battery_mv", "left_drive", "right_drive", "joy_x", "joy_y",
+  "target_speed", "intake", "ball_control", "flags", "loop_us"
+};
+
+//Expands every file found in one buffer, returns the number of bad files
+static int expand(const char *source, const unsigned char *data, long size) {
+  BlackboxHeader header;
+  Delta delta;
+  int values[BLACKBOX_FIELDS];
+  long offset = 0;
+  long end;
+  uint32_t sample;
+  int used;
+  int failed = 0;
+  int i;
+
+  while(offset + (long)sizeof(header) <= size) {
+    memcpy(&header, data + offset, sizeof(header));
+    if(memcmp(header.magic, BLACKBOX_MAGIC, sizeof(header.magic)) != 0 ||
+        header.fields != BLACKBOX_FIELDS) {
+      fprintf(stderr, "bbexpand: %s: no black-box file at byte %ld\n", source, offset);
+      return failed + 1;
+    }
+    offset += sizeof(header);
+    end = offset + (long)header.length;
+    if(end > size) {
+      fprintf(stderr, "bbexpand: %s: session %lu is truncated\n", source,
+        (unsigned long)header.session);
+      failed++;
+      end = size;
+    }
+
+    deltaReset(&delta, BLACKBOX_FIELDS);
+    for(sample = 0; sample < header.samples && offset < end; sample++) {
+      used = deltaDecode(&delta, data + offset, (int)(end - offset), values);
+      if(used < 0) {
+        fprintf(stderr, "bbexpand: %s: session %lu is corrupt after %lu samples\n", source,
+          (unsigned long)header.session, (unsigned long)sample);
+        failed++;
+        break;
+      }
+      offset += used;
+      printf("%lu", (unsigned long)header.session);
+      for(i = 0; i < BLACKBOX_FIELDS; i++) {
+        printf(",%d", values[i]);
+      }
+      printf("\n");
+    }
+    fprintf(stderr, "bbexpand: %s: session %lu, %lu samples every %u ms, %lu dropped\n",
+      source, (unsigned long)header.session, (unsigned long)sample, (unsigned)header.period,
+      (unsigned long)header.dropped);
+    offset = end;
+  }
+  return failed;
+}
+
+static unsigned char *slurp(FILE *in, long *size) {
+  unsigned char *data = NULL;
+  long capacity = 0;
+  size_t got;
+
+  *size = 0;
+  do {
+    if(*size == capacity) {
+      capacity = capacity ? capacity * 2 : 65536;
+      data = realloc(data, capacity);
+      if(!data) {
+        return NULL;
+      }
+    }
+    got = fread(data + *size, 1, capacity - *size, in);
+    *size += got;
+  } while(got > 0);
+  return data;
+}
+
+int main(int argc, char **argv) {
+  unsigned char *data;
+  long size;
+  int failed = 0;
+  int i;
+  FILE *in;
+
+  printf("session");
+  for(i = 0; i < BLACKBOX_FIELDS; i++) {
+    printf(",%s", fieldNames[i]);
+  }
+  printf("\n");
+
+  for(i = 1; i < argc || i == 1; i++) {
+    in = i < argc ? fopen(argv[i], "rb") : stdin;
+    if(!in) {
+      perror(argv[i]);
+      failed++;
+      continue;
+    }
+    data = slurp(in, &size);
+    if(in != stdin) {
+      fclose(in);
+    }
+    if(!data) {
+      fprintf(stderr, "bbexpand: out of memory\n");
+      return 1;
+    }
+    failed += expand(i < argc ? argv[i] : "stdin", data, size);
+    free(data);
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+/** @file controltest.cpp
+ * @brief Host tests for the Pid and RingBuffer templates in control.h
+ *
+ * Runs each template through the cases its users rely on and prints one line per failure.
+ * Exits non-zero if anything failed. Built with sim/prosnames.h forced in, like the robot
+ * sources in the simulator, since control.h brings in API.h and its stdio.
+ */
+
+#include "control.h"
+
+//API.h's printf was renamed out of the way; this is the host's
+#undef printf
+extern "C" int printf(const char *format, ...);
+
+static int failures;
+
+static void expect(const char *what, int got, int want) {
+  if(got != want) {
+    printf("controltest: %s gave %d, expected %d\n", what, got, want);
+    failures++;
+  }
+}
+
+//The replay drift correction's gains in control.cpp
+struct HalfGains {
+  static constexpr int kp = 128;
+  static constexpr int ki = 0;
+  static constexpr int kd = 0;
+  static constexpr int shift = 8;
+  static constexpr int limit = 40;
+};
+
+struct FullGains {
+  static constexpr int kp = 256;
+  static constexpr int ki = 64;
+  static constexpr int kd = 512;
+  static constexpr int shift = 8;
+  static constexpr int limit = 100;
+};
+
+static void testPid() {
+  control::Pid<HalfGains> half;
+  control::Pid<FullGains> full;
+  int i;
+
+  expect("half gain of 10", half.step(10), 5);
+  expect("half gain of -10", half.step(-10), -5);
+  expect("half gain limit", half.step(1000), 40);
+  expect("half gain negative limit", half.step(-1000), -40);
+
+  //First period: P 10 + I 2.5, no derivative kick
+  expect("first step", full.step(10), 12);
+  //Second period: P 10 + I 5 + D 0
+  expect("steady step", full.step(10), 15);
+  //Error jumps by 10: P 20 + I 10 + D 20
+  expect("derivative step", full.step(20), 50);
+  for(i = 0; i < 100; i++) {
+    full.step(100);
+  }
+  expect("wound up output", full.step(100), 100);
+  //The integral is bounded by the limit, so it unwinds within a few periods of a reversal
+  full.step(-100);
+  full.step(-100);
+  full.step(-100);
+  expect("unwound output", full.step(-100), -100);
+  full.reset();
+  expect("reset step", full.step(0), 0);
+}
+
+static void testRingBuffer() {
+  control::RingBuffer<int, 4> ring;
+  int value = 0;
+  int i;
+
+  expect("new ring is empty", ring.empty(), 1);
+  expect("pop from empty", ring.pop(value), 0);
+  for(i = 1; i <= 4; i++) {
+    expect("push to fill", ring.push(i), 1);
+  }
+  expect("push to full", ring.push(5), 0);
+  expect("full size", ring.size(), 4);
+  expect("pop oldest", ring.pop(value) ? value : -1, 1);
+  //Run the counters past several wraps of the storage, as the flywheel history does
+  for(i = 5; i < 1000; i++) {
+    expect("push after pop", ring.push(i), 1);
+    expect("pop in order", ring.pop(value) ? value : -1, i - 3);
+  }
+  expect("size after wraps", ring.size(), 3);
+  while(ring.pop(value));
+  expect("drained ring is empty", ring.empty(), 1);
+}
+
+int main() {
+  testPid();
+  testRingBuffer();
+  if(failures > 0) {
+    return 1;
+  }
+  printf("controltest: all passed\n");
+  return 0;
+}
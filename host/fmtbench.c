@@ -0,0 +1,133 @@
+/** @file fmtbench.c
+ * @brief Host benchmark for the lightweight number formatter
+ *
+ * Checks fmt.c against snprintf() over a spread of values, then times both on the LCD and
+ * telemetry shapes the robot actually prints. Host timings only show the relative cost, not
+ * Cortex-M3 cycles.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "fmt.h"
+
+#define ITERATIONS 2000000
+
+static volatile int sink;
+
+static const int samples[] = {
+  0, 1, -1, 9, 10, 59, 68, 83, -127, 127, 999, 1000, 27000, -27000, 100000,
+  123456789, INT_MAX, INT_MIN
+};
+#define SAMPLE_COUNT ((int)(sizeof(samples) / sizeof(samples[0])))
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int check(const char *what, const char *got, const char *want) {
+  if(strcmp(got, want) != 0) {
+    fprintf(stderr, "fmtbench: %s wrote \"%s\", expected \"%s\"\n", what, got, want);
+    return 1;
+  }
+  return 0;
+}
+
+static int verify() {
+  char got[32];
+  char want[32];
+  int failed = 0;
+  int i;
+  int v;
+
+  for(i = 0; i < SAMPLE_COUNT; i++) {
+    v = samples[i];
+    fmtInt(got, v);
+    snprintf(want, sizeof(want), "%d", v);
+    failed |= check("fmtInt", got, want);
+    fmtUnsigned(got, (unsigned int)v);
+    snprintf(want, sizeof(want), "%u", (unsigned int)v);
+    failed |= check("fmtUnsigned", got, want);
+    fmtPadded(got, v, 6, ' ');
+    snprintf(want, sizeof(want), "%6d", v);
+    failed |= check("fmtPadded", got, want);
+    fmtPadded(got, v, 6, '0');
+    snprintf(want, sizeof(want), "%06d", v);
+    failed |= check("fmtPadded zero", got, want);
+    fmtHex(got, (unsigned int)v, 8);
+    snprintf(want, sizeof(want), "%08X", (unsigned int)v);
+    failed |= check("fmtHex", got, want);
+    if(v != INT_MIN) {
+      fmtFixed(got, v, 3);
+      snprintf(want, sizeof(want), "%s%d.%03d", v < 0 ? "-" : "", abs(v) / 1000,
+        abs(v) % 1000);
+      failed |= check("fmtFixed", got, want);
+    }
+  }
+  return failed;
+}
+
+static void report(const char *what, double fmtTime, double printfTime) {
+  printf("%-28s fmt %6.1f ns/call   snprintf %6.1f ns/call   %4.1fx\n", what,
+    fmtTime * 1e9 / ITERATIONS, printfTime * 1e9 / ITERATIONS, printfTime / fmtTime);
+}
+
+int main() {
+  char out[32];
+  double start;
+  double fmtTime;
+  int i;
+
+  if(verify()) {
+    return 1;
+  }
+
+  start = now();
+  for(i = 0; i < ITERATIONS; i++) {
+    char *p = out;
+    p += fmtInt(p, samples[i % SAMPLE_COUNT] >> 8);
+    *p++ = ' ';
+    p += fmtText(p, "Speed", 8);
+    sink += out[0];
+  }
+  fmtTime = now() - start;
+  start = now();
+  for(i = 0; i < ITERATIONS; i++) {
+    snprintf(out, sizeof(out), "%d %s", samples[i % SAMPLE_COUNT] >> 8, "Speed");
+    sink += out[0];
+  }
+  report("LCD line \"%d Speed\"", fmtTime, now() - start);
+
+  start = now();
+  for(i = 0; i < ITERATIONS; i++) {
+    fmtFixed(out, samples[i % SAMPLE_COUNT] >> 12, 3);
+    sink += out[0];
+  }
+  fmtTime = now() - start;
+  start = now();
+  for(i = 0; i < ITERATIONS; i++) {
+    int v = samples[i % SAMPLE_COUNT] >> 12;
+    snprintf(out, sizeof(out), "%s%d.%03d", v < 0 ? "-" : "", abs(v) / 1000, abs(v) % 1000);
+    sink += out[0];
+  }
+  report("fixed point \"%d.%03d\"", fmtTime, now() - start);
+
+  start = now();
+  for(i = 0; i < ITERATIONS; i++) {
+    fmtHex(out, (unsigned int)samples[i % SAMPLE_COUNT], 4);
+    sink += out[0];
+  }
+  fmtTime = now() - start;
+  start = now();
+  for(i = 0; i < ITERATIONS; i++) {
+    snprintf(out, sizeof(out), "%04X", (unsigned int)samples[i % SAMPLE_COUNT] & 0xFFFF);
+    sink += out[0];
+  }
+  report("hex \"%04X\"", fmtTime, now() - start);
+  return 0;
+}
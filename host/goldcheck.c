@@ -0,0 +1,146 @@
+/** @file goldcheck.c
+ * @brief Host tool that compares simulator metrics against a stored baseline
+ *
+ * A baseline holds one "name value tolerance" line per metric. The sign of the tolerance says
+ * which way is worse: "+150" fails when the metric rises more than 150 over the baseline,
+ * "-2" fails when it falls more than 2 under it. Moves the other way are reported as better
+ * and never fail, so a baseline only needs refreshing to lock in an improvement.
+ *
+ * Usage: goldcheck baseline metrics [--update]
+ *   --update rewrites the baseline values from the metrics, keeping names and tolerances
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define GOLD_MAX_METRICS 32
+#define GOLD_NAME_SIZE 32
+
+typedef struct {
+  char name[GOLD_NAME_SIZE];
+  double value;
+  double tolerance;
+  char sign;     //'+' or '-' for baselines
+} GoldMetric;
+
+//Reads "name value [tolerance]" lines, skipping blanks and # comments
+static int load(const char *path, GoldMetric *metrics, int baseline) {
+  char line[256];
+  char tolerance[32];
+  int count = 0;
+  int fields;
+  FILE *in = fopen(path, "r");
+
+  if(!in) {
+    perror(path);
+    return -1;
+  }
+  while(fgets(line, sizeof(line), in) && count < GOLD_MAX_METRICS) {
+    if(line[0] == '#') {
+      continue;
+    }
+    fields = sscanf(line, "%31s %lf %31s", metrics[count].name, &metrics[count].value,
+      tolerance);
+    if(fields <= 0) {
+      continue;
+    }
+    if(fields < (baseline ? 3 : 2) || (baseline && tolerance[0] != '+' && tolerance[0] != '-')) {
+      fprintf(stderr, "goldcheck: %s: bad line \"%s\"\n", path, strtok(line, "\n"));
+      fclose(in);
+      return -1;
+    }
+    if(baseline) {
+      metrics[count].sign = tolerance[0];
+      sscanf(tolerance + 1, "%lf", &metrics[count].tolerance);
+    }
+    count++;
+  }
+  fclose(in);
+  return count;
+}
+
+static const GoldMetric *find(const GoldMetric *metrics, int count, const char *name) {
+  int i;
+
+  for(i = 0; i < count; i++) {
+    if(strcmp(metrics[i].name, name) == 0) {
+      return &metrics[i];
+    }
+  }
+  return NULL;
+}
+
+static int update(const char *path, GoldMetric *baseline, int count, const GoldMetric *measured,
+    int measuredCount) {
+  const GoldMetric *m;
+  FILE *out;
+  int i;
+
+  for(i = 0; i < count; i++) {
+    if((m = find(measured, measuredCount, baseline[i].name))) {
+      baseline[i].value = m->value;
+    }
+  }
+  if(!(out = fopen(path, "w"))) {
+    perror(path);
+    return 1;
+  }
+  fprintf(out, "# metric baseline tolerance (sign marks the worse direction)\n");
+  for(i = 0; i < count; i++) {
+    fprintf(out, "%s %.2f %c%g\n", baseline[i].name, baseline[i].value, baseline[i].sign,
+      baseline[i].tolerance);
+  }
+  fclose(out);
+  printf("goldcheck: %s updated\n", path);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  GoldMetric baseline[GOLD_MAX_METRICS];
+  GoldMetric measured[GOLD_MAX_METRICS];
+  const GoldMetric *m;
+  const char *status;
+  double delta;
+  int baseCount;
+  int measuredCount;
+  int failed = 0;
+  int i;
+
+  if(argc < 3 || (argc > 3 && strcmp(argv[3], "--update") != 0)) {
+    fprintf(stderr, "usage: goldcheck baseline metrics [--update]\n");
+    return 2;
+  }
+  if((baseCount = load(argv[1], baseline, 1)) < 0 ||
+      (measuredCount = load(argv[2], measured, 0)) < 0) {
+    return 2;
+  }
+  if(argc > 3) {
+    return update(argv[1], baseline, baseCount, measured, measuredCount);
+  }
+
+  printf("%s\n", argv[1]);
+  for(i = 0; i < baseCount; i++) {
+    m = find(measured, measuredCount, baseline[i].name);
+    if(!m) {
+      printf("  %-14s %10.2f %10s %10s  MISSING\n", baseline[i].name, baseline[i].value, "-",
+        "-");
+      failed++;
+      continue;
+    }
+    delta = m->value - baseline[i].value;
+    if(baseline[i].sign == '-') { //Positive delta means worse from here on
+      delta = -delta;
+    }
+    if(delta > baseline[i].tolerance) {
+      status = "WORSE";
+      failed++;
+    } else if(delta < -baseline[i].tolerance) {
+      status = "better";
+    } else {
+      status = "ok";
+    }
+    printf("  %-14s %10.2f %10.2f %+10.2f  %s\n", baseline[i].name, baseline[i].value, m->value,
+      m->value - baseline[i].value, status);
+  }
+  return failed ? 1 : 0;
+}
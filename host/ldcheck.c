@@ -0,0 +1,20 @@
+/** @file ldcheck.c
+ * @brief Stand-in object for checking firmware/cortex.ld with the host linker
+ *
+ * The section placement in cortex.ld does not depend on the instruction set, so linking this
+ * through it with the native ld exercises the same layout rules and ASSERTs an ARM link does.
+ * The .ramfunc code is not a multiple of the .data alignment, which leaves a gap between the
+ * two sections for the load addresses to get wrong.
+ */
+
+__attribute__((section(".ramfunc"))) int ldcheckRam(int value) {
+  return value * 3 + 1;
+}
+
+__attribute__((aligned(16))) int ldcheckTable[4] = {1, 2, 3, 4};
+int ldcheckValue = 5;
+int ldcheckZero;
+
+void ldcheckStart() {
+  ldcheckZero = ldcheckRam(ldcheckValue) + ldcheckTable[1];
+}
@@ -0,0 +1,959 @@
+/** @file api.c
+ * @brief PROS API implemented on the host simulator
+ *
+ * Compiled with prosnames.h forced in, like the robot sources, so that API.h's stdio names
+ * become private to the robot side. Everything here is a thin layer over the kernel, the
+ * physics state and the host I/O hooks; behaviour follows the contracts documented in API.h,
+ * including the ones that differ from the C library (fread() and fwrite() return bytes).
+ */
+
+#include <API.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sim.h"
+
+//API.h owns the stdio names on this side, so the one host formatter needed is declared here
+int vsnprintf(char *buffer, size_t limit, const char *format, va_list args);
+
+//Stream numbers below this are the serial ports and stdout
+#define SIM_FIRST_FILE 4
+#define SIM_MAX_OPEN 4
+#define SIM_NAME_LENGTH 8
+#define SIM_PRINT_BUFFER 256
+#define SIM_LCD_WIDTH 16
+
+typedef struct {
+  unsigned char top;
+  bool reverse;
+  int zero;
+  bool used;
+} SimEncoder;
+
+typedef struct {
+  unsigned char port;
+  unsigned short multiplier;
+  double zero;
+  bool used;
+} SimGyro;
+
+typedef struct {
+  unsigned char echo;
+  bool used;
+} SimUltrasonic;
+
+typedef struct {
+  char name[SIM_NAME_LENGTH + 1];
+  unsigned char *data;
+  unsigned int length;
+  unsigned int capacity;
+  bool used;
+} SimFile;
+
+typedef struct {
+  int file;
+  unsigned int position;
+  bool write;
+  bool used;
+} SimOpen;
+
+typedef struct {
+  bool given;
+  bool mutex;
+  int owner;
+  uint32_t waiters; //Bit per kernel task id
+  bool used;
+} SimLock;
+
+typedef struct {
+  void (*fn)(void);
+  unsigned long increment;
+} SimLoop;
+
+static SimEncoder encoders[BOARD_NR_GPIO_PINS];
+static SimGyro gyros[BOARD_NR_ADC_PINS];
+static SimUltrasonic ultrasonics[BOARD_NR_GPIO_PINS];
+static SimFile files[SIM_MAX_FILES];
+static SimOpen opened[SIM_MAX_OPEN];
+static SimLock locks[64];
+static SimLoop loops[TASK_MAX];
+static int calibration[BOARD_NR_ADC_PINS + 1];
+static unsigned char modes[BOARD_NR_GPIO_PINS + 1];
+static bool outputs[BOARD_NR_GPIO_PINS + 1];
+static InterruptHandler handlers[BOARD_NR_GPIO_PINS + 1];
+static unsigned char interruptEdges[BOARD_NR_GPIO_PINS + 1];
+static char lcd[2][SIM_LCD_WIDTH + 1];
+
+// -------------------- Competition --------------------
+
+bool isAutonomous() {
+  return sim.autonomous;
+}
+
+bool isEnabled() {
+  return sim.enabled;
+}
+
+bool isJoystickConnected(unsigned char joystick) {
+  return joystick == 1;
+}
+
+bool isOnline() {
+  return true;
+}
+
+int joystickGetAnalog(unsigned char joystick, unsigned char axis) {
+  if(joystick != 1 || axis < 1 || axis > 6) {
+    return 0;
+  }
+  return sim.joyAxis[axis];
+}
+
+bool joystickGetDigital(unsigned char joystick, unsigned char buttonGroup,
+    unsigned char button) {
+  if(joystick != 1 || buttonGroup < 5 || buttonGroup > 8) {
+    return false;
+  }
+  return (sim.joyButtons >> ((buttonGroup - 5) * 4) & button) != 0;
+}
+
+unsigned int powerLevelBackup() {
+  return (unsigned int)(sim.backup * 1000);
+}
+
+unsigned int powerLevelMain() {
+  return (unsigned int)(sim.battery * 1000);
+}
+
+void setTeamName(const char *name) {
+}
+
+// -------------------- Pin control --------------------
+
+int analogCalibrate(unsigned char channel) {
+  if(channel < 1 || channel > BOARD_NR_ADC_PINS) {
+    return 0;
+  }
+  calibration[channel] = sim.analog[channel];
+  return calibration[channel];
+}
+
+int analogRead(unsigned char channel) {
+  if(channel < 1 || channel > BOARD_NR_ADC_PINS) {
+    return 0;
+  }
+  return sim.analog[channel];
+}
+
+int analogReadCalibrated(unsigned char channel) {
+  return analogRead(channel) - calibration[channel < 1 || channel > BOARD_NR_ADC_PINS ? 0 :
+    channel];
+}
+
+int analogReadCalibratedHR(unsigned char channel) {
+  return analogReadCalibrated(channel) * 16;
+}
+
+bool digitalRead(unsigned char pin) {
+  if(pin < 1 || pin > 12) {
+    return false;
+  }
+  if(modes[pin] == OUTPUT || modes[pin] == OUTPUT_OD) {
+    return outputs[pin];
+  }
+  return sim.digital[pin];
+}
+
+void digitalWrite(unsigned char pin, bool value) {
+  if(pin >= 1 && pin <= 12) {
+    outputs[pin] = value;
+  }
+}
+
+void pinMode(unsigned char pin, unsigned char mode) {
+  if(pin >= 1 && pin <= 12) {
+    modes[pin] = mode;
+  }
+}
+
+void ioClearInterrupt(unsigned char pin) {
+  if(pin >= 1 && pin <= 12) {
+    handlers[pin] = NULL;
+  }
+}
+
+void ioSetInterrupt(unsigned char pin, unsigned char edges, InterruptHandler handler) {
+  if(pin >= 1 && pin <= 12) {
+    interruptEdges[pin] = edges;
+    handlers[pin] = handler;
+  }
+}
+
+void simDigitalSet(unsigned char pin, bool level) {
+  bool was;
+
+  if(pin < 1 || pin > 12) {
+    return;
+  }
+  was = sim.digital[pin];
+  sim.digital[pin] = level;
+  if(handlers[pin] && was != level &&
+      (interruptEdges[pin] & (level ? INTERRUPT_EDGE_RISING : INTERRUPT_EDGE_FALLING))) {
+    handlers[pin](pin);
+  }
+}
+
+// -------------------- Motors and sensors --------------------
+
+int motorGet(unsigned char channel) {
+  return channel >= 1 && channel <= 10 ? sim.motor[channel] : 0;
+}
+
+void motorSet(unsigned char channel, int speed) {
+  if(channel < 1 || channel > 10) {
+    return;
+  }
+  if(speed > 127) {
+    speed = 127;
+  } else if(speed < -127) {
+    speed = -127;
+  }
+  sim.motor[channel] = speed;
+}
+
+void motorStop(unsigned char channel) {
+  motorSet(channel, 0);
+}
+
+void motorStopAll() {
+  memset(sim.motor, 0, sizeof(sim.motor));
+}
+
+void speakerInit() {
+}
+
+void speakerPlayArray(const char * * songs) {
+}
+
+void speakerPlayRtttl(const char *song) {
+}
+
+void speakerShutdown() {
+}
+
+unsigned int imeInitializeAll() {
+  return 0; //No IMEs on this robot
+}
+
+bool imeGet(unsigned char address, int *value) {
+  return false;
+}
+
+bool imeGetVelocity(unsigned char address, int *value) {
+  return false;
+}
+
+bool imeReset(unsigned char address) {
+  return false;
+}
+
+void imeShutdown() {
+}
+
+//The gyro follows the simulated heading, scaled like the real one by its multiplier
+static double simGyroDegrees(const SimGyro *gyro) {
+  return sim.heading * 180 / 3.14159265358979 * (gyro->multiplier ? gyro->multiplier : 196) /
+    196;
+}
+
+int gyroGet(Gyro gyro) {
+  SimGyro *g = (SimGyro *)gyro;
+  double degrees;
+
+  if(!g) {
+    return 0;
+  }
+  degrees = simGyroDegrees(g) - g->zero;
+  return (int)(degrees < 0 ? degrees - 0.5 : degrees + 0.5);
+}
+
+Gyro gyroInit(unsigned char port, unsigned short multiplier) {
+  SimGyro *g;
+
+  if(port < 1 || port > BOARD_NR_ADC_PINS || gyros[port - 1].used) {
+    return NULL;
+  }
+  g = &gyros[port - 1];
+  g->port = port;
+  g->multiplier = multiplier;
+  g->used = true;
+  gyroReset(g);
+  return g;
+}
+
+void gyroReset(Gyro gyro) {
+  SimGyro *g = (SimGyro *)gyro;
+
+  if(g) {
+    g->zero = simGyroDegrees(g);
+  }
+}
+
+void gyroShutdown(Gyro gyro) {
+  if(gyro) {
+    ((SimGyro *)gyro)->used = false;
+  }
+}
+
+static int simEncoderRaw(const SimEncoder *e) {
+  int ticks = simEncoderTicks(e->top);
+
+  return e->reverse ? -ticks : ticks;
+}
+
+int encoderGet(Encoder enc) {
+  SimEncoder *e = (SimEncoder *)enc;
+
+  return e ? simEncoderRaw(e) - e->zero : 0;
+}
+
+Encoder encoderInit(unsigned char portTop, unsigned char portBottom, bool reverse) {
+  SimEncoder *e;
+
+  if(portTop < 1 || portTop > 12 || portTop == 10 || portBottom < 1 || portBottom > 12 ||
+      encoders[portTop - 1].used) {
+    return NULL;
+  }
+  e = &encoders[portTop - 1];
+  e->top = portTop;
+  e->reverse = reverse;
+  e->used = true;
+  encoderReset(e);
+  return e;
+}
+
+void encoderReset(Encoder enc) {
+  SimEncoder *e = (SimEncoder *)enc;
+
+  if(e) {
+    e->zero = simEncoderRaw(e);
+  }
+}
+
+void encoderShutdown(Encoder enc) {
+  if(enc) {
+    ((SimEncoder *)enc)->used = false;
+  }
+}
+
+int ultrasonicGet(Ultrasonic ult) {
+  if(!ult) {
+    return 0;
+  }
+  return sim.range > 0 ? (int)(sim.range * 100) : -1;
+}
+
+Ultrasonic ultrasonicInit(unsigned char portEcho, unsigned char portPing) {
+  SimUltrasonic *u;
+
+  if(portEcho < 1 || portEcho > 12 || portEcho == 10 || portPing < 1 || portPing > 12 ||
+      ultrasonics[portEcho - 1].used) {
+    return NULL;
+  }
+  u = &ultrasonics[portEcho - 1];
+  u->echo = portEcho;
+  u->used = true;
+  return u;
+}
+
+void ultrasonicShutdown(Ultrasonic ult) {
+  if(ult) {
+    ((SimUltrasonic *)ult)->used = false;
+  }
+}
+
+// -------------------- Files and serial --------------------
+
+static int simSerialPort(FILE *stream) {
+  int port = (int)(intptr_t)stream;
+
+  return port >= 1 && port < SIM_FIRST_FILE ? port : 0;
+}
+
+static SimOpen *simOpened(FILE *stream) {
+  int slot = (int)(intptr_t)stream - SIM_FIRST_FILE;
+
+  if(slot < 0 || slot >= SIM_MAX_OPEN || !opened[slot].used) {
+    return NULL;
+  }
+  return &opened[slot];
+}
+
+static int simFileFind(const char *name) {
+  int i;
+
+  for(i = 0; i < SIM_MAX_FILES; i++) {
+    if(files[i].used && strncmp(files[i].name, name, SIM_NAME_LENGTH) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int simFileCreate(const char *name) {
+  int i = simFileFind(name);
+
+  if(i < 0) {
+    for(i = 0; i < SIM_MAX_FILES && files[i].used; i++);
+    if(i == SIM_MAX_FILES) {
+      return -1;
+    }
+    strncpy(files[i].name, name, SIM_NAME_LENGTH);
+    files[i].name[SIM_NAME_LENGTH] = '\0';
+    files[i].used = true;
+  }
+  files[i].length = 0;
+  return i;
+}
+
+static bool simFileAppend(SimFile *file, const void *data, unsigned int length) {
+  unsigned char *grown;
+  unsigned int capacity = file->capacity ? file->capacity : 256;
+
+  while(capacity < file->length + length) {
+    capacity *= 2;
+  }
+  if(capacity != file->capacity) {
+    grown = realloc(file->data, capacity);
+    if(!grown) {
+      return false;
+    }
+    file->data = grown;
+    file->capacity = capacity;
+  }
+  memcpy(file->data + file->length, data, length);
+  file->length += length;
+  return true;
+}
+
+bool simFileSet(const char *name, const void *data, unsigned int length) {
+  int i = simFileCreate(name);
+
+  return i >= 0 && simFileAppend(&files[i], data, length);
+}
+
+const void *simFileGet(unsigned int index, const char **name, unsigned int *length) {
+  unsigned int i;
+
+  for(i = 0; i < SIM_MAX_FILES; i++) {
+    if(files[i].used && index-- == 0) {
+      *name = files[i].name;
+      *length = files[i].length;
+      return files[i].data ? (const void *)files[i].data : (const void *)"";
+    }
+  }
+  return NULL;
+}
+
+void usartInit(FILE *usart, unsigned int baud, unsigned int flags) {
+}
+
+void usartShutdown(FILE *usart) {
+}
+
+void fclose(FILE *stream) {
+  SimOpen *open = simOpened(stream);
+
+  if(open) {
+    open->used = false;
+  }
+}
+
+int fcount(FILE *stream) {
+  SimOpen *open = simOpened(stream);
+  int port = simSerialPort(stream);
+
+  if(port) {
+    return (int)simSerialAvailable(port);
+  }
+  return open && !open->write ? (int)(files[open->file].length - open->position) : 0;
+}
+
+int fdelete(const char *file) {
+  int i = simFileFind(file);
+
+  if(i < 0) {
+    return 1;
+  }
+  files[i].used = false;
+  files[i].length = 0;
+  return 0;
+}
+
+int feof(FILE *stream) {
+  SimOpen *open = simOpened(stream);
+  int port = simSerialPort(stream);
+
+  if(port) {
+    return simSerialAvailable(port) == 0;
+  }
+  return !open || open->write || open->position >= files[open->file].length;
+}
+
+int fflush(FILE *stream) {
+  return 0;
+}
+
+//Reads one byte, blocking on serial ports as the robot does
+static int simGetc(FILE *stream) {
+  SimOpen *open = simOpened(stream);
+  int port = simSerialPort(stream);
+  int value;
+
+  if(port) {
+    while((value = simSerialRead(port)) < 0) {
+      delay(1);
+    }
+    return value;
+  }
+  if(!open || open->write || open->position >= files[open->file].length) {
+    return EOF;
+  }
+  return files[open->file].data[open->position++];
+}
+
+int fgetc(FILE *stream) {
+  return simGetc(stream);
+}
+
+char* fgets(char *str, int num, FILE *stream) {
+  int count = 0;
+  int value;
+
+  while(count < num - 1) {
+    value = simGetc(stream);
+    if(value == EOF) {
+      break;
+    }
+    str[count++] = (char)value;
+    if(value == '\n') {
+      break;
+    }
+  }
+  if(count == 0) {
+    return NULL;
+  }
+  str[count] = '\0';
+  return str;
+}
+
+FILE * fopen(const char *file, const char *mode) {
+  int slot;
+  int i;
+
+  for(slot = 0; slot < SIM_MAX_OPEN && opened[slot].used; slot++);
+  if(slot == SIM_MAX_OPEN || !file || !mode) {
+    return NULL;
+  }
+  if(mode[0] == 'w') {
+    for(i = 0; i < SIM_MAX_OPEN; i++) {
+      if(opened[i].used && opened[i].write) {
+        return NULL; //Only one file may be open for writing
+      }
+    }
+    i = simFileCreate(file);
+  } else if(mode[0] == 'r') {
+    i = simFileFind(file);
+  } else {
+    return NULL;
+  }
+  if(i < 0) {
+    return NULL;
+  }
+  opened[slot].file = i;
+  opened[slot].position = 0;
+  opened[slot].write = mode[0] == 'w';
+  opened[slot].used = true;
+  return (FILE *)(intptr_t)(SIM_FIRST_FILE + slot);
+}
+
+size_t fwrite(const void *ptr, size_t size, size_t count, FILE *stream) {
+  SimOpen *open = simOpened(stream);
+  int port = simSerialPort(stream);
+  size_t length = size * count;
+
+  if(port) {
+    simSerialWrite(port, ptr, (unsigned int)length);
+    return length;
+  }
+  if(!open || !open->write || !simFileAppend(&files[open->file], ptr, (unsigned int)length)) {
+    return 0;
+  }
+  open->position = files[open->file].length;
+  return length;
+}
+
+size_t fread(void *ptr, size_t size, size_t count, FILE *stream) {
+  SimOpen *open = simOpened(stream);
+  unsigned char *out = (unsigned char *)ptr;
+  size_t length = size * count;
+  size_t i;
+  int value;
+
+  if(simSerialPort(stream)) {
+    for(i = 0; i < length; i++) {
+      out[i] = (unsigned char)simGetc(stream);
+    }
+    return length;
+  }
+  if(!open || open->write) {
+    return 0;
+  }
+  for(i = 0; i < length && (value = simGetc(stream)) != EOF; i++) {
+    out[i] = (unsigned char)value;
+  }
+  return i;
+}
+
+int fseek(FILE *stream, long int offset, int origin) {
+  SimOpen *open = simOpened(stream);
+  long int base;
+
+  if(!open || open->write) {
+    return 1;
+  }
+  base = origin == SEEK_SET ? 0 : (origin == SEEK_CUR ? (long int)open->position :
+    (long int)files[open->file].length);
+  if(base + offset < 0 || base + offset > (long int)files[open->file].length) {
+    return 1;
+  }
+  open->position = (unsigned int)(base + offset);
+  return 0;
+}
+
+long int ftell(FILE *stream) {
+  SimOpen *open = simOpened(stream);
+
+  return open ? (long int)open->position : -1;
+}
+
+void fprint(const char *string, FILE *stream) {
+  fwrite(string, 1, strlen(string), stream);
+}
+
+int fputc(int value, FILE *stream) {
+  unsigned char byte = (unsigned char)value;
+
+  fwrite(&byte, 1, 1, stream);
+  return value;
+}
+
+int fputs(const char *string, FILE *stream) {
+  fprint(string, stream);
+  fputc('\n', stream);
+  return (int)strlen(string);
+}
+
+int getchar() {
+  return simSerialAvailable(3) ? simSerialRead(3) : -1;
+}
+
+void print(const char *string) {
+  fprint(string, stdout);
+}
+
+int putchar(int value) {
+  return fputc(value, stdout);
+}
+
+int puts(const char *string) {
+  return fputs(string, stdout);
+}
+
+int fprintf(FILE *stream, const char *formatString, ...) {
+  char buffer[SIM_PRINT_BUFFER];
+  va_list args;
+  int length;
+
+  va_start(args, formatString);
+  length = vsnprintf(buffer, sizeof(buffer), formatString, args);
+  va_end(args);
+  fprint(buffer, stream);
+  return length;
+}
+
+int printf(const char *formatString, ...) {
+  char buffer[SIM_PRINT_BUFFER];
+  va_list args;
+  int length;
+
+  va_start(args, formatString);
+  length = vsnprintf(buffer, sizeof(buffer), formatString, args);
+  va_end(args);
+  print(buffer);
+  return length;
+}
+
+int snprintf(char *buffer, size_t limit, const char *formatString, ...) {
+  va_list args;
+  int length;
+
+  va_start(args, formatString);
+  length = vsnprintf(buffer, limit, formatString, args);
+  va_end(args);
+  return length;
+}
+
+int sprintf(char *buffer, const char *formatString, ...) {
+  va_list args;
+  int length;
+
+  va_start(args, formatString);
+  length = vsnprintf(buffer, INT_MAX, formatString, args);
+  va_end(args);
+  return length;
+}
+
+// -------------------- LCD --------------------
+
+void lcdClear(FILE *lcdPort) {
+  lcdSetText(lcdPort, 1, "");
+  lcdSetText(lcdPort, 2, "");
+}
+
+void lcdInit(FILE *lcdPort) {
+}
+
+void lcdPrint(FILE *lcdPort, unsigned char line, const char *formatString, ...) {
+  char buffer[SIM_PRINT_BUFFER];
+  va_list args;
+
+  va_start(args, formatString);
+  vsnprintf(buffer, sizeof(buffer), formatString, args);
+  va_end(args);
+  lcdSetText(lcdPort, line, buffer);
+}
+
+unsigned int lcdReadButtons(FILE *lcdPort) {
+  return (unsigned int)sim.lcdButtons;
+}
+
+void lcdSetBacklight(FILE *lcdPort, bool backlight) {
+}
+
+void lcdSetText(FILE *lcdPort, unsigned char line, const char *buffer) {
+  char text[SIM_LCD_WIDTH + 1];
+
+  if(line < 1 || line > 2) {
+    return;
+  }
+  strncpy(text, buffer, SIM_LCD_WIDTH);
+  text[SIM_LCD_WIDTH] = '\0';
+  if(strcmp(text, lcd[line - 1]) != 0) {
+    strcpy(lcd[line - 1], text);
+    simLcdWrite(line, text);
+  }
+}
+
+void lcdShutdown(FILE *lcdPort) {
+}
+
+// -------------------- Tasks --------------------
+
+static int simTaskId(TaskHandle task) {
+  return task ? (int)(intptr_t)task - 1 : simTaskCurrent();
+}
+
+TaskHandle taskCreate(TaskCode taskCode, const unsigned int stackDepth, void *parameters,
+    const unsigned int priority) {
+  int id = simTaskCreate(taskCode, parameters, priority);
+
+  return id < 0 ? NULL : (TaskHandle)(intptr_t)(id + 1);
+}
+
+void taskDelay(const unsigned long msToDelay) {
+  simSleepUntil(simNow() + (uint64_t)msToDelay * 1000);
+}
+
+void taskDelayUntil(unsigned long *previousWakeTime, const unsigned long cycleTime) {
+  *previousWakeTime += cycleTime;
+  simSleepUntil((uint64_t)*previousWakeTime * 1000);
+}
+
+void taskDelete(TaskHandle taskToDelete) {
+  int id = simTaskId(taskToDelete);
+
+  if(id == simTaskCurrent()) {
+    simTaskExit();
+  } else {
+    simTaskKill(id);
+  }
+}
+
+unsigned int taskGetCount() {
+  return (unsigned int)simTaskCount();
+}
+
+unsigned int taskGetState(TaskHandle task) {
+  return simTaskState(simTaskId(task));
+}
+
+unsigned int taskPriorityGet(const TaskHandle task) {
+  return simTaskPriority(simTaskId(task));
+}
+
+void taskPrioritySet(TaskHandle task, const unsigned int newPriority) {
+  simTaskSetPriority(simTaskId(task), newPriority);
+}
+
+void taskResume(TaskHandle taskToResume) {
+  simTaskSuspend(simTaskId(taskToResume), false);
+}
+
+static void simLoopTask(void *param) {
+  SimLoop *loop = (SimLoop *)param;
+  bool autonomous = sim.autonomous;
+  unsigned long wake = millis();
+
+  while(sim.enabled && sim.autonomous == autonomous) {
+    loop->fn();
+    taskDelayUntil(&wake, loop->increment);
+  }
+  loop->fn(); //One further invocation after the mode changes, as documented
+  loop->fn = NULL;
+}
+
+TaskHandle taskRunLoop(void (*fn)(void), const unsigned long increment) {
+  int i;
+
+  for(i = 0; i < TASK_MAX && loops[i].fn; i++);
+  if(i == TASK_MAX) {
+    return NULL;
+  }
+  loops[i].fn = fn;
+  loops[i].increment = increment;
+  return taskCreate(simLoopTask, TASK_DEFAULT_STACK_SIZE, &loops[i], TASK_PRIORITY_DEFAULT + 1);
+}
+
+void taskSuspend(TaskHandle taskToSuspend) {
+  simTaskSuspend(simTaskId(taskToSuspend), true);
+}
+
+// -------------------- Semaphores and mutexes --------------------
+
+static SimLock *simLockCreate(bool mutex) {
+  int i;
+
+  for(i = 0; i < (int)(sizeof(locks) / sizeof(locks[0])) && locks[i].used; i++);
+  if(i == (int)(sizeof(locks) / sizeof(locks[0]))) {
+    return NULL;
+  }
+  locks[i].given = true;
+  locks[i].mutex = mutex;
+  locks[i].owner = -1;
+  locks[i].waiters = 0;
+  locks[i].used = true;
+  return &locks[i];
+}
+
+static bool simLockGive(SimLock *lock) {
+  int id;
+
+  if(!lock || lock->given) {
+    return false;
+  }
+  lock->given = true;
+  lock->owner = -1;
+  for(id = 0; id < SIM_MAX_TASKS; id++) {
+    if(lock->waiters & (1u << id)) {
+      simTaskWake(id);
+    }
+  }
+  lock->waiters = 0;
+  return true;
+}
+
+static bool simLockTake(SimLock *lock, unsigned long blockTime) {
+  int self = simTaskCurrent();
+  uint64_t deadline = simNow() + (uint64_t)blockTime * 1000;
+
+  if(!lock) {
+    return false;
+  }
+  while(!lock->given) {
+    if(self < 0 || (blockTime != (unsigned long)-1 && simNow() >= deadline)) {
+      return false;
+    }
+    lock->waiters |= 1u << self;
+    simSleepUntil(blockTime == (unsigned long)-1 ? UINT64_MAX : deadline);
+  }
+  lock->given = false;
+  lock->owner = self;
+  return true;
+}
+
+Semaphore semaphoreCreate() {
+  return simLockCreate(false);
+}
+
+bool semaphoreGive(Semaphore semaphore) {
+  return simLockGive((SimLock *)semaphore);
+}
+
+bool semaphoreTake(Semaphore semaphore, const unsigned long blockTime) {
+  return simLockTake((SimLock *)semaphore, blockTime);
+}
+
+void semaphoreDelete(Semaphore semaphore) {
+  if(semaphore) {
+    ((SimLock *)semaphore)->used = false;
+  }
+}
+
+Mutex mutexCreate() {
+  return simLockCreate(true);
+}
+
+bool mutexGive(Mutex mutex) {
+  SimLock *lock = (SimLock *)mutex;
+
+  if(lock && lock->owner != simTaskCurrent()) {
+    return false;
+  }
+  return simLockGive(lock);
+}
+
+bool mutexTake(Mutex mutex, const unsigned long blockTime) {
+  return simLockTake((SimLock *)mutex, blockTime);
+}
+
+void mutexDelete(Mutex mutex) {
+  semaphoreDelete(mutex);
+}
+
+// -------------------- Time --------------------
+
+void delay(const unsigned long time) {
+  taskDelay(time);
+}
+
+void delayMicroseconds(const unsigned long us) {
+  simSleepUntil(simNow() + us);
+}
+
+unsigned long micros() {
+  return (unsigned long)simNow();
+}
+
+unsigned long millis() {
+  return (unsigned long)(simNow() / 1000);
+}
+
+void wait(const unsigned long time) {
+  taskDelay(time);
+}
+
+void waitUntil(unsigned long *previousWakeTime, const unsigned long time) {
+  taskDelayUntil(previousWakeTime, time);
+}
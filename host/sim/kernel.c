@@ -0,0 +1,221 @@
+/** @file kernel.c
+ * @brief Cooperative scheduler and virtual clock for the host simulator
+ *
+ * Each robot task is a ucontext coroutine with its own stack. The scheduler always resumes the
+ * live task with the earliest wake time (highest priority first on ties, then the one that ran
+ * least recently), stepping the physics up to that time first. Virtual time only moves while
+ * every task is asleep, so code between two delays takes no simulated time and a run is as
+ * fast as the host can switch contexts.
+ */
+
+#include <stdlib.h>
+#include <ucontext.h>
+
+#include "sim.h"
+
+//Host stack per task; robot tasks are sized for 2 KB so this is plenty
+#define SIM_STACK_SIZE (64 * 1024)
+
+typedef struct {
+  ucontext_t context;
+  void *stack;
+  SimTaskFn fn;
+  void *arg;
+  unsigned int priority;
+  uint64_t wake;
+  unsigned long ran;   //Dispatch count when last resumed, for round robin
+  bool alive;
+  bool suspended;
+} SimTask;
+
+static SimTask tasks[SIM_MAX_TASKS];
+static ucontext_t scheduler;
+static int current = -1;
+static uint64_t now;
+static uint64_t physicsTime;
+static unsigned long dispatches;
+static bool woken; //Set by simTaskWake(), checked after each physics step
+
+static void simTaskEntry() {
+  SimTask *task = &tasks[current];
+
+  task->fn(task->arg);
+  task->alive = false; //Returning through uc_link lands back in simRunUntil()
+}
+
+int simTaskCreate(SimTaskFn fn, void *arg, unsigned int priority) {
+  SimTask *task;
+  int id;
+
+  for(id = 0; id < SIM_MAX_TASKS && tasks[id].alive; id++);
+  if(id == SIM_MAX_TASKS) {
+    return -1;
+  }
+  task = &tasks[id];
+  if(!task->stack && !(task->stack = malloc(SIM_STACK_SIZE))) {
+    return -1;
+  }
+  getcontext(&task->context);
+  task->context.uc_stack.ss_sp = task->stack;
+  task->context.uc_stack.ss_size = SIM_STACK_SIZE;
+  task->context.uc_link = &scheduler;
+  makecontext(&task->context, simTaskEntry, 0);
+  task->fn = fn;
+  task->arg = arg;
+  task->priority = priority;
+  task->wake = now;
+  task->ran = 0;
+  task->alive = true;
+  task->suspended = false;
+  return id;
+}
+
+void simTaskKill(int id) {
+  if(id == current) {
+    simFatal("a task cannot kill itself, return from it instead");
+  }
+  if(id >= 0 && id < SIM_MAX_TASKS) {
+    tasks[id].alive = false; //The stack is kept for the next task created in this slot
+  }
+}
+
+bool simTaskAlive(int id) {
+  return id >= 0 && id < SIM_MAX_TASKS && tasks[id].alive;
+}
+
+void simTaskExit() {
+  if(current < 0) {
+    simFatal("task exit called outside of a task");
+  }
+  tasks[current].alive = false;
+  swapcontext(&tasks[current].context, &scheduler); //Never resumed
+}
+
+int simTaskCurrent() {
+  return current;
+}
+
+int simTaskCount() {
+  int count = 0;
+  int id;
+
+  for(id = 0; id < SIM_MAX_TASKS; id++) {
+    if(tasks[id].alive) {
+      count++;
+    }
+  }
+  return count;
+}
+
+unsigned int simTaskState(int id) {
+  if(!simTaskAlive(id)) {
+    return 0;
+  }
+  if(id == current) {
+    return 1;
+  }
+  if(tasks[id].suspended) {
+    return 4;
+  }
+  return tasks[id].wake <= now ? 2 : 3;
+}
+
+unsigned int simTaskPriority(int id) {
+  return simTaskAlive(id) ? tasks[id].priority : 0;
+}
+
+void simTaskSetPriority(int id, unsigned int priority) {
+  if(simTaskAlive(id)) {
+    tasks[id].priority = priority;
+  }
+}
+
+void simTaskSuspend(int id, bool suspended) {
+  if(simTaskAlive(id)) {
+    tasks[id].suspended = suspended;
+  }
+  if(suspended && id == current) {
+    simSleepUntil(now);
+  }
+}
+
+void simSleepUntil(uint64_t wake) {
+  SimTask *task;
+
+  if(current < 0) {
+    simFatal("delay called outside of a task");
+  }
+  task = &tasks[current];
+  task->wake = wake;
+  swapcontext(&task->context, &scheduler);
+}
+
+void simTaskWake(int id) {
+  if(simTaskAlive(id) && tasks[id].wake > now) {
+    tasks[id].wake = now;
+    woken = true;
+  }
+}
+
+uint64_t simNow() {
+  return now;
+}
+
+//Runs the physics up to a time, returns false if it stopped early because it woke a task
+static bool simAdvance(uint64_t until) {
+  woken = false;
+  while(physicsTime + SIM_STEP <= until) {
+    physicsTime += SIM_STEP;
+    now = physicsTime; //Tasks woken by the physics, if any, see the step time
+    simPhysicsStep();
+    if(woken) { //An interrupt woke a task, let it run before the next step
+      return false;
+    }
+  }
+  if(until > now) {
+    now = until;
+  }
+  return true;
+}
+
+static int simNextTask() {
+  int next = -1;
+  int id;
+  SimTask *task;
+  SimTask *best;
+
+  for(id = 0; id < SIM_MAX_TASKS; id++) {
+    task = &tasks[id];
+    if(!task->alive || task->suspended) {
+      continue;
+    }
+    best = next < 0 ? NULL : &tasks[next];
+    if(!best || task->wake < best->wake || (task->wake == best->wake &&
+        (task->priority > best->priority ||
+        (task->priority == best->priority && task->ran < best->ran)))) {
+      next = id;
+    }
+  }
+  return next;
+}
+
+void simRunUntil(uint64_t end) {
+  int next;
+
+  while(1) {
+    next = simNextTask();
+    if(next < 0 || tasks[next].wake > end) {
+      if(simAdvance(end)) {
+        return;
+      }
+      continue;
+    }
+    if(!simAdvance(tasks[next].wake)) {
+      continue;
+    }
+    current = next;
+    tasks[next].ran = ++dispatches;
+    swapcontext(&scheduler, &tasks[next].context);
+    current = -1;
+  }
+}
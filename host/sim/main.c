@@ -0,0 +1,572 @@
+/** @file main.c
+ * @brief Runner for the host simulator
+ *
+ * Boots the robot code the way PROS does (initializeIO(), then initialize() in a task, then
+ * the competition modes in order), plays a scenario of joystick, LCD and sensor events against
+ * it, and reports what happened. The whole match runs on the virtual clock, so a two minute
+ * match takes a fraction of a second of host time.
+ *
+ * Usage: sim [options] [scenario]
+ *   --trace FILE   write the robot state every SIM_TRACE_PERIOD ms as CSV
+ *   --uart2 FILE   capture the uart2 byte stream (telemetry, for teledecode)
+ *   --stdout FILE  capture the robot's stdout instead of printing it
+ *   --stdin FILE   feed a file to the robot's stdin
+ *   --fs DIR       load the robot's flash files from DIR and save them back at the end
+ *   --metrics FILE write the control quality metrics from metrics.c, one "name value" a line
+ *   --lcd          print LCD changes to stderr
+ *   --quiet        no summary
+ *
+ * Scenario lines, with # comments:
+ *   pin N high|low            digital input level at power on (jumpers)
+ *   analog N VALUE            analog input reading at power on
+ *   stuck N VALUE             analog input frozen at a reading for the whole run, a failed sensor
+ *   balls HELD FIELD          preloads in the conveyor and balls on the floor
+ *   range METRES              distance to the goal for ultrasonics
+ *   mode disabled|auto|driver MS
+ *                             appends a competition phase
+ *   at MS EVENT               an event MS after the start of the last mode line:
+ *     stick AXIS VALUE        joystick axis 1 to 6
+ *     press BUTTONS           hold joystick buttons such as 6U,8D
+ *     release BUTTONS         let them go
+ *     lcd BUTTONS             hold LCD buttons from L, C and R, or - for none
+ *     pin N high|low          drive a digital input
+ *     analog N VALUE          set an analog input
+ *     range METRES            move the goal
+ *
+ * Without mode lines a standard match is run: auto 15 s, disabled 1 s, driver 105 s,
+ * disabled 1 s.
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim.h"
+
+//Robot entry points, from main.h, which cannot be included next to the host stdio
+void initializeIO();
+void initialize();
+void autonomous();
+void operatorControl();
+
+#define SIM_MAX_PHASES 32
+#define SIM_MAX_EVENTS 4096
+#define SIM_TRACE_PERIOD 10
+#define SIM_INIT_LIMIT 60000
+#define SIM_INPUT_BUFFER 65536
+//Kernel priorities above every robot task, so inputs land before the robot looks at them
+#define SIM_SCRIPT_PRIORITY 100
+#define SIM_TRACE_PRIORITY 99
+#define SIM_METRICS_PRIORITY 98
+//Robot task priority for autonomous() and operatorControl(), TASK_PRIORITY_DEFAULT
+#define SIM_MODE_PRIORITY 2
+
+typedef enum {MODE_DISABLED, MODE_AUTO, MODE_DRIVER} SimMode;
+
+typedef enum {EVENT_STICK, EVENT_PRESS, EVENT_RELEASE, EVENT_LCD, EVENT_PIN,
+  EVENT_ANALOG, EVENT_RANGE} SimEventType;
+
+typedef struct {
+  SimMode mode;
+  unsigned long length;
+} SimPhase;
+
+typedef struct {
+  int phase;          //Index of the phase the time is relative to
+  unsigned long time; //Milliseconds after the phase starts
+  SimEventType type;
+  int target;
+  int value;
+} SimEvent;
+
+typedef struct {
+  unsigned char data[SIM_INPUT_BUFFER];
+  unsigned int length;
+  unsigned int position;
+} SimInput;
+
+static const char *const modeNames[] = {"disabled", "auto", "driver"};
+
+static SimPhase phases[SIM_MAX_PHASES];
+static int phaseCount;
+static SimEvent events[SIM_MAX_EVENTS];
+static int eventCount;
+static uint64_t phaseStart[SIM_MAX_PHASES];
+static SimMode mode;
+
+static FILE *traceOut;
+static FILE *uart2Out;
+static FILE *stdoutOut;
+static FILE *metricsOut;
+static SimInput stdinInput;
+static bool showLcd;
+static char lcdText[2][17];
+static double minBattery;
+
+// -------------------- Host I/O hooks --------------------
+
+void simSerialWrite(int port, const void *data, unsigned int length) {
+  if(port == 2 && uart2Out) {
+    fwrite(data, 1, length, uart2Out);
+  } else if(port == 3) {
+    fwrite(data, 1, length, stdoutOut ? stdoutOut : stdout);
+  }
+}
+
+void simLcdWrite(int line, const char *text) {
+  strncpy(lcdText[line - 1], text, 16);
+  if(showLcd) {
+    fprintf(stderr, "%8.3f LCD%d |%-16s|\n", simNow() * 1e-6, line, text);
+  }
+}
+
+int simSerialRead(int port) {
+  if(port != 3 || stdinInput.position >= stdinInput.length) {
+    return -1;
+  }
+  return stdinInput.data[stdinInput.position++];
+}
+
+unsigned int simSerialAvailable(int port) {
+  return port == 3 ? stdinInput.length - stdinInput.position : 0;
+}
+
+void simFatal(const char *message) {
+  fprintf(stderr, "sim: %8.3f %s\n", simNow() * 1e-6, message);
+  exit(2);
+}
+
+// -------------------- Scenario --------------------
+
+static int simButtons(const char *text, bool lcd) {
+  static const char letters[] = "DLUR"; //JOY_DOWN, JOY_LEFT, JOY_UP, JOY_RIGHT bit order
+  const char *bit;
+  int buttons = 0;
+
+  for(; *text; text++) {
+    if(lcd) {
+      buttons |= *text == 'L' ? 1 : *text == 'C' ? 2 : *text == 'R' ? 4 : 0;
+    } else if(*text >= '5' && *text <= '8' && text[1] && (bit = strchr(letters, text[1]))) {
+      buttons |= 1 << ((*text - '5') * 4 + (bit - letters));
+      text++;
+    }
+  }
+  return buttons;
+}
+
+static bool simParseLine(char *line) {
+  char word[16];
+  char arg[64];
+  char level[8];
+  unsigned long time;
+  unsigned long length;
+  int n;
+  int value;
+  double metres;
+  SimEvent *event;
+
+  if(strchr(line, '#')) {
+    *strchr(line, '#') = '\0';
+  }
+  if(sscanf(line, "%15s", word) != 1) {
+    return true;
+  }
+  if(strcmp(word, "pin") == 0 && sscanf(line, "%*s %d %7s", &n, level) == 2) {
+    sim.digital[n < 1 || n > 12 ? 0 : n] = strcmp(level, "high") == 0;
+  } else if(strcmp(word, "analog") == 0 && sscanf(line, "%*s %d %d", &n, &value) == 2) {
+    sim.analog[n < 1 || n > 8 ? 0 : n] = value;
+  } else if(strcmp(word, "stuck") == 0 && sscanf(line, "%*s %d %d", &n, &value) == 2) {
+    sim.analog[n < 1 || n > 8 ? 0 : n] = value;
+    sim.stuck[n < 1 || n > 8 ? 0 : n] = true;
+  } else if(strcmp(word, "balls") == 0 &&
+      sscanf(line, "%*s %d %d", &sim.ballsHeld, &sim.fieldBalls) == 2) {
+  } else if(strcmp(word, "range") == 0 && sscanf(line, "%*s %lf", &sim.range) == 1) {
+  } else if(strcmp(word, "mode") == 0 && sscanf(line, "%*s %15s %lu", arg, &length) == 2 &&
+      phaseCount < SIM_MAX_PHASES) {
+    for(n = 0; n < 3 && strcmp(arg, modeNames[n]) != 0; n++);
+    if(n == 3) {
+      return false;
+    }
+    phases[phaseCount].mode = (SimMode)n;
+    phases[phaseCount].length = length;
+    phaseCount++;
+  } else if(strcmp(word, "at") == 0 && eventCount < SIM_MAX_EVENTS &&
+      sscanf(line, "%*s %lu %15s %63s", &time, word, arg) == 3) {
+    event = &events[eventCount];
+    event->phase = phaseCount - 1;
+    event->time = time;
+    if(strcmp(word, "stick") == 0 && sscanf(line, "%*s %*s %*s %d %d", &n, &value) == 2) {
+      event->type = EVENT_STICK;
+      event->target = n;
+      event->value = value;
+    } else if(strcmp(word, "press") == 0 || strcmp(word, "release") == 0) {
+      event->type = word[0] == 'p' ? EVENT_PRESS : EVENT_RELEASE;
+      event->value = simButtons(arg, false);
+    } else if(strcmp(word, "lcd") == 0) {
+      event->type = EVENT_LCD;
+      event->value = simButtons(arg, true);
+    } else if(strcmp(word, "pin") == 0 &&
+        sscanf(line, "%*s %*s %*s %d %7s", &n, level) == 2) {
+      event->type = EVENT_PIN;
+      event->target = n;
+      event->value = strcmp(level, "high") == 0;
+    } else if(strcmp(word, "analog") == 0 &&
+        sscanf(line, "%*s %*s %*s %d %d", &n, &value) == 2) {
+      event->type = EVENT_ANALOG;
+      event->target = n;
+      event->value = value;
+    } else if(strcmp(word, "range") == 0 && sscanf(arg, "%lf", &metres) == 1) {
+      event->type = EVENT_RANGE;
+      event->value = (int)(metres * 100 + 0.5); //Centimetres, the ultrasonic's resolution
+    } else {
+      return false;
+    }
+    eventCount++;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool simLoadScenario(const char *path) {
+  char line[256];
+  int number = 0;
+  FILE *in = fopen(path, "r");
+
+  if(!in) {
+    perror(path);
+    return false;
+  }
+  while(fgets(line, sizeof(line), in)) {
+    number++;
+    if(!simParseLine(line)) {
+      fprintf(stderr, "sim: %s:%d: cannot parse \"%s\"\n", path, number, strtok(line, "\n"));
+      fclose(in);
+      return false;
+    }
+  }
+  fclose(in);
+  return true;
+}
+
+static void simDefaultMatch() {
+  static const SimPhase match[] = {
+    {MODE_AUTO, 15000}, {MODE_DISABLED, 1000}, {MODE_DRIVER, 105000}, {MODE_DISABLED, 1000}
+  };
+
+  memcpy(phases, match, sizeof(match));
+  phaseCount = sizeof(match) / sizeof(match[0]);
+}
+
+// -------------------- Flash files --------------------
+
+static bool simLoadFiles(const char *dir) {
+  char path[512];
+  unsigned char data[SIM_INPUT_BUFFER];
+  size_t length;
+  struct dirent *entry;
+  DIR *d = opendir(dir);
+  FILE *in;
+
+  if(!d) {
+    return true; //Starts with empty flash, created on save
+  }
+  while((entry = readdir(d))) {
+    if(entry->d_name[0] == '.') {
+      continue;
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+    if((in = fopen(path, "rb"))) {
+      length = fread(data, 1, sizeof(data), in);
+      fclose(in);
+      if(!simFileSet(entry->d_name, data, (unsigned int)length)) {
+        fprintf(stderr, "sim: flash is full, %s not loaded\n", entry->d_name);
+      }
+    }
+  }
+  closedir(d);
+  return true;
+}
+
+static void simSaveFiles(const char *dir) {
+  char path[512];
+  const char *name;
+  const void *data;
+  unsigned int length;
+  unsigned int i;
+  FILE *out;
+
+  snprintf(path, sizeof(path), "mkdir -p '%s'", dir);
+  if(system(path) != 0) {
+    return;
+  }
+  for(i = 0; (data = simFileGet(i, &name, &length)); i++) {
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    if((out = fopen(path, "wb"))) {
+      fwrite(data, 1, length, out);
+      fclose(out);
+    }
+  }
+}
+
+static bool simLoadInput(SimInput *input, const char *path) {
+  FILE *in = fopen(path, "rb");
+
+  if(!in) {
+    perror(path);
+    return false;
+  }
+  input->length = (unsigned int)fread(input->data, 1, sizeof(input->data), in);
+  input->position = 0;
+  fclose(in);
+  return true;
+}
+
+// -------------------- Tasks --------------------
+
+static void simApply(const SimEvent *event) {
+  switch(event->type) {
+  case EVENT_STICK:
+    if(event->target >= 1 && event->target <= 6) {
+      sim.joyAxis[event->target] = event->value;
+    }
+    break;
+  case EVENT_PRESS:
+    sim.joyButtons |= event->value;
+    break;
+  case EVENT_RELEASE:
+    sim.joyButtons &= ~event->value;
+    break;
+  case EVENT_LCD:
+    sim.lcdButtons = event->value;
+    break;
+  case EVENT_PIN:
+    simDigitalSet((unsigned char)event->target, event->value != 0);
+    break;
+  case EVENT_ANALOG:
+    if(event->target >= 1 && event->target <= 8) {
+      sim.analog[event->target] = event->value;
+    }
+    break;
+  case EVENT_RANGE:
+    sim.range = event->value / 100.0;
+    break;
+  }
+}
+
+static uint64_t simEventTime(const SimEvent *event) {
+  return (event->phase < 0 ? 0 : phaseStart[event->phase]) + event->time * 1000;
+}
+
+static int simEventOrder(const void *a, const void *b) {
+  uint64_t ta = simEventTime((const SimEvent *)a);
+  uint64_t tb = simEventTime((const SimEvent *)b);
+
+  if(ta != tb) {
+    return ta < tb ? -1 : 1;
+  }
+  return (const SimEvent *)a < (const SimEvent *)b ? -1 : 1; //Keep file order on ties
+}
+
+static void simScript(void *ignore) {
+  int i;
+
+  for(i = 0; i < eventCount; i++) {
+    simSleepUntil(simEventTime(&events[i]));
+    simApply(&events[i]);
+  }
+}
+
+static void simTrace(void *ignore) {
+  uint64_t wake = simNow();
+
+  fprintf(traceOut, "time_ms,mode,battery_mv,current_a,flywheel_speed,flywheel_power,"
+    "left_drive,right_drive,intake,ball_control,x_m,y_m,heading_deg,balls_held,balls_fired,"
+    "flywheel_ptc_c\n");
+  while(1) {
+    fprintf(traceOut, "%lu,%s,%d,%.2f,%.1f,%d,%d,%d,%d,%d,%.3f,%.3f,%.1f,%d,%d,%.1f\n",
+      (unsigned long)(simNow() / 1000), modeNames[mode], (int)(sim.battery * 1000),
+      sim.current, sim.flywheelSpeed * 360 / (2 * 3.14159265358979) * 0.02, sim.motor[9],
+      sim.motor[4], sim.motor[6], sim.motor[5], sim.motor[10], sim.x, sim.y,
+      sim.heading * 180 / 3.14159265358979, sim.ballsHeld, sim.ballsFired,
+      sim.ptc[9]);
+    wake += SIM_TRACE_PERIOD * 1000;
+    simSleepUntil(wake);
+  }
+}
+
+static void simInitialize(void *ignore) {
+  initialize();
+}
+
+static void simAutonomous(void *ignore) {
+  autonomous();
+  simMetricsAutonomousDone();
+}
+
+static void simOperatorControl(void *ignore) {
+  operatorControl();
+}
+
+//Runs to the end of a phase, sampling the battery low point on the way
+static void simRunPhase(uint64_t end) {
+  while(simNow() < end) {
+    simRunUntil(simNow() + SIM_TRACE_PERIOD * 1000 < end ? simNow() + SIM_TRACE_PERIOD * 1000 :
+      end);
+    if(sim.battery < minBattery) {
+      minBattery = sim.battery;
+    }
+  }
+}
+
+// -------------------- Main --------------------
+
+static double simWallClock() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  const char *scenario = NULL;
+  const char *fsDir = NULL;
+  bool quiet = false;
+  double started = simWallClock();
+  double wall;
+  uint64_t end;
+  int modeTask = -1;
+  const SimMetric *metric;
+  int init;
+  int i;
+
+  simPhysicsInit();
+  for(i = 1; i <= 12; i++) {
+    sim.digital[i] = true; //Unconnected digital inputs are pulled up
+  }
+  sim.ballsHeld = 4; //Match preloads
+  minBattery = sim.battery;
+
+  for(i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "--lcd") == 0) {
+      showLcd = true;
+    } else if(strcmp(argv[i], "--quiet") == 0) {
+      quiet = true;
+    } else if(i + 1 < argc && strcmp(argv[i], "--trace") == 0) {
+      if(!(traceOut = fopen(argv[++i], "w"))) {
+        perror(argv[i]);
+        return 1;
+      }
+    } else if(i + 1 < argc && strcmp(argv[i], "--uart2") == 0) {
+      if(!(uart2Out = fopen(argv[++i], "wb"))) {
+        perror(argv[i]);
+        return 1;
+      }
+    } else if(i + 1 < argc && strcmp(argv[i], "--stdout") == 0) {
+      if(!(stdoutOut = fopen(argv[++i], "wb"))) {
+        perror(argv[i]);
+        return 1;
+      }
+    } else if(i + 1 < argc && strcmp(argv[i], "--metrics") == 0) {
+      if(!(metricsOut = fopen(argv[++i], "w"))) {
+        perror(argv[i]);
+        return 1;
+      }
+    } else if(i + 1 < argc && strcmp(argv[i], "--stdin") == 0) {
+      if(!simLoadInput(&stdinInput, argv[++i])) {
+        return 1;
+      }
+    } else if(i + 1 < argc && strcmp(argv[i], "--fs") == 0) {
+      fsDir = argv[++i];
+    } else if(argv[i][0] != '-' && !scenario) {
+      scenario = argv[i];
+    } else {
+      fprintf(stderr, "usage: sim [--trace FILE] [--uart2 FILE] [--stdout FILE] "
+        "[--stdin FILE] [--fs DIR] [--metrics FILE] [--lcd] [--quiet] [scenario]\n");
+      return 1;
+    }
+  }
+  if(scenario && !simLoadScenario(scenario)) {
+    return 1;
+  }
+  if(phaseCount == 0) {
+    simDefaultMatch();
+  }
+  if(fsDir && !simLoadFiles(fsDir)) {
+    return 1;
+  }
+
+  //PROS runs initializeIO() before the scheduler, then initialize() in a task while disabled
+  initializeIO();
+  init = simTaskCreate(simInitialize, NULL, SIM_MODE_PRIORITY);
+  while(simTaskAlive(init)) {
+    if(simNow() >= (uint64_t)SIM_INIT_LIMIT * 1000) {
+      simFatal("initialize() did not return");
+    }
+    simRunUntil(simNow() + 1000);
+  }
+
+  //Phases start once initialize() is done; events are then placed on the absolute timeline
+  end = simNow();
+  for(i = 0; i < phaseCount; i++) {
+    phaseStart[i] = end;
+    end += (uint64_t)phases[i].length * 1000;
+  }
+  qsort(events, eventCount, sizeof(events[0]), simEventOrder);
+  simTaskCreate(simScript, NULL, SIM_SCRIPT_PRIORITY);
+  if(traceOut) {
+    simTaskCreate(simTrace, NULL, SIM_TRACE_PRIORITY);
+  }
+  simMetricsStart(SIM_METRICS_PRIORITY);
+
+  for(i = 0; i < phaseCount; i++) {
+    //Like the competition switch, a mode change ends the old mode task and stops the motors
+    if(modeTask >= 0 && simTaskAlive(modeTask)) {
+      simTaskKill(modeTask);
+    }
+    modeTask = -1;
+    memset(sim.motor, 0, sizeof(sim.motor));
+    mode = phases[i].mode;
+    sim.enabled = mode != MODE_DISABLED;
+    sim.autonomous = mode == MODE_AUTO;
+    if(mode == MODE_AUTO) {
+      modeTask = simTaskCreate(simAutonomous, NULL, SIM_MODE_PRIORITY);
+    } else if(mode == MODE_DRIVER) {
+      modeTask = simTaskCreate(simOperatorControl, NULL, SIM_MODE_PRIORITY);
+    }
+    simRunPhase(phaseStart[i] + (uint64_t)phases[i].length * 1000);
+  }
+  wall = simWallClock() - started;
+
+  if(fsDir) {
+    simSaveFiles(fsDir);
+  }
+  if(metricsOut) {
+    for(i = 0; (metric = simMetricsGet(i)); i++) {
+      if(metric->valid) {
+        fprintf(metricsOut, "%s %.2f\n", metric->name, metric->value);
+      }
+    }
+    fclose(metricsOut);
+  }
+  if(traceOut) {
+    fclose(traceOut);
+  }
+  if(uart2Out) {
+    fclose(uart2Out);
+  }
+  if(stdoutOut) {
+    fclose(stdoutOut);
+  }
+  if(!quiet) {
+    fprintf(stderr, "sim: %.1f s simulated in %.3f s (%.0fx real time)\n", simNow() * 1e-6, wall,
+      simNow() * 1e-6 / wall);
+    fprintf(stderr, "sim: %d balls fired, %d picked up, %d held; battery min %.2f V, "
+      "end %.2f V; %d PTC trips\n", sim.ballsFired, sim.ballsPicked, sim.ballsHeld, minBattery,
+      sim.battery, sim.ptcTrips);
+    fprintf(stderr, "sim: LCD |%-16s|%-16s|\n", lcdText[0], lcdText[1]);
+  }
+  return 0;
+}
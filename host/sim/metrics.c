@@ -0,0 +1,154 @@
+/** @file metrics.c
+ * @brief Control quality metrics for the host simulator
+ *
+ * Compiled on the robot side like api.c so it can ask the flywheel task directly for what it
+ * measured, rather than second-guessing it from the physics. A sampler task looks at the
+ * robot every METRICS_PERIOD ms:
+ *
+ * - spinup_ms: from the first change of target to flywheelLongRange until flywheelReady()
+ * - steady_error: mean |speed - target| once a target has first been reached
+ * - ready_pct: share of those same samples where flywheelReady() was true
+ * - shots: balls that left the robot
+ * - shots_per_s: rate within volleys, shots no more than METRICS_VOLLEY_GAP ms apart
+ * - auto_shots: balls fired in autonomous
+ * - auto_done_ms: when the last autonomous ball left, or when autonomous() returned if it
+ *   fired none; routines that run to the buzzer are still timed by when they finished scoring
+ */
+
+#include <API.h>
+#include <string.h>
+
+#include "flywheel.h"
+#include "sim.h"
+
+#define METRICS_PERIOD 10
+#define METRICS_VOLLEY_GAP 1500
+
+static SimMetric metrics[] = {
+  {"spinup_ms", 0, false},
+  {"steady_error", 0, false},
+  {"ready_pct", 0, false},
+  {"shots", 0, false},
+  {"shots_per_s", 0, false},
+  {"auto_shots", 0, false},
+  {"auto_done_ms", 0, false},
+};
+enum {SPINUP, STEADY_ERROR, READY_PCT, SHOTS, SHOTS_PER_S, AUTO_SHOTS, AUTO_DONE};
+
+static unsigned long autoStart;
+static unsigned long autoReturned;
+static unsigned long autoLastShot;
+static bool autoSeen;
+
+static void simMetricsTask(void *ignore) {
+  unsigned long wake = millis();
+  unsigned long spinupStart = 0;
+  unsigned long settled = 0;
+  unsigned long ready = 0;
+  unsigned long errorSum = 0;
+  unsigned long volleyFirst = 0;
+  unsigned long volleyLast = 0;
+  unsigned long volleyTime = 0;
+  unsigned int volleyShots = 0;
+  unsigned int volleyGaps = 0;
+  unsigned long gaps;
+  unsigned long span;
+  unsigned long done;
+  int fired = sim.ballsFired;
+  int target = 0;
+  bool reached = false;
+  bool spinning = false;
+  bool wasAutonomous = false;
+
+  while(1) {
+    //Targets
+    if(flywheelGetTarget() != target) {
+      target = flywheelGetTarget();
+      reached = false;
+      if(target == flywheelLongRange.speed && !metrics[SPINUP].valid && !spinning) {
+        spinupStart = wake;
+        spinning = true;
+      }
+    }
+    if(target > 0 && flywheelReady()) {
+      reached = true;
+      if(spinning) {
+        spinning = false;
+        metrics[SPINUP].value = wake - spinupStart;
+        metrics[SPINUP].valid = true;
+      }
+    }
+    if(target > 0 && reached) {
+      settled++;
+      errorSum += abs(flywheelGetSpeed() - target);
+      ready += flywheelReady() ? 1 : 0;
+    }
+
+    //Shots and volleys
+    if(sim.enabled && sim.autonomous && !wasAutonomous) {
+      autoStart = wake;
+      autoSeen = true;
+    }
+    wasAutonomous = sim.enabled && sim.autonomous;
+    while(fired < sim.ballsFired) {
+      fired++;
+      if(wasAutonomous) {
+        metrics[AUTO_SHOTS].value++;
+        autoLastShot = wake;
+      }
+      if(volleyShots > 0 && wake - volleyLast <= METRICS_VOLLEY_GAP) {
+        volleyShots++;
+      } else {
+        if(volleyShots > 1) {
+          volleyTime += volleyLast - volleyFirst;
+          volleyGaps += volleyShots - 1;
+        }
+        volleyFirst = wake;
+        volleyShots = 1;
+      }
+      volleyLast = wake;
+    }
+
+    //Publish
+    metrics[SHOTS].value = sim.ballsFired;
+    metrics[SHOTS].valid = true;
+    metrics[STEADY_ERROR].valid = metrics[READY_PCT].valid = settled > 0;
+    if(settled > 0) {
+      metrics[STEADY_ERROR].value = (double)errorSum / settled;
+      metrics[READY_PCT].value = 100.0 * ready / settled;
+    }
+    gaps = volleyGaps;
+    span = volleyTime;
+    if(volleyShots > 1) { //Include the volley still going
+      gaps += volleyShots - 1;
+      span += volleyLast - volleyFirst;
+    }
+    if(span > 0) {
+      metrics[SHOTS_PER_S].value = 1000.0 * gaps / span;
+      metrics[SHOTS_PER_S].valid = true;
+    }
+    if(spinning) { //Not reached yet counts as the whole run so far
+      metrics[SPINUP].value = wake - spinupStart;
+      metrics[SPINUP].valid = true;
+    }
+    if(autoSeen) {
+      done = metrics[AUTO_SHOTS].value > 0 ? autoLastShot : autoReturned;
+      metrics[AUTO_SHOTS].valid = true;
+      metrics[AUTO_DONE].valid = done > 0;
+      metrics[AUTO_DONE].value = done > autoStart ? done - autoStart : 0;
+    }
+    taskDelayUntil(&wake, METRICS_PERIOD);
+  }
+}
+
+void simMetricsStart(unsigned int priority) {
+  simTaskCreate(simMetricsTask, NULL, priority);
+}
+
+void simMetricsAutonomousDone() {
+  autoReturned = millis();
+}
+
+const SimMetric *simMetricsGet(unsigned int index) {
+  return index < sizeof(metrics) / sizeof(metrics[0]) ? &metrics[index] : NULL;
+}
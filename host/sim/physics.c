@@ -0,0 +1,322 @@
+/** @file physics.c
+ * @brief Robot physics for the host simulator
+ *
+ * Every motor is a VEX 393 modelled as a DC motor: the command sets a fraction of the battery
+ * voltage, back EMF and winding resistance set the current, and the current sets the torque.
+ * The summed current sags the battery through its internal resistance one step later, so a
+ * flywheel spin-up visibly pulls down the voltage the drive sees. Ports and sensors follow
+ * the wiring in auto.c and init.c, and the conveyor sensors in events.h and ball.h.
+ *
+ * Each motor's PTC fuse heats with the square of its current and cools towards ambient. Once
+ * it passes its trip temperature the motor goes dead until the fuse has cooled to its reset
+ * temperature, which takes about half a minute. The fuse is deliberately not the one thermal.c
+ * assumes: that model takes the datasheet's guaranteed hold current, while a real fuse holds
+ * somewhere between its hold and trip ratings, heats at a rate the datasheet only bounds, and
+ * sits in a pit warmer than a lab. The simulated fuse picks its own values for all three, so a
+ * scenario that stays untripped says the derating has margin, not that the model agrees with
+ * itself.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sim.h"
+
+#define SIM_DT (SIM_STEP * 1e-6)
+#define SIM_PI 3.14159265358979
+
+//393 motor at the rated 7.2 V: stall current, free current and free speed (torque gearing)
+#define MOTOR_VOLTS 7.2
+#define MOTOR_STALL_AMPS 4.8
+#define MOTOR_FREE_AMPS 0.37
+#define MOTOR_RESISTANCE (MOTOR_VOLTS / MOTOR_STALL_AMPS)
+#define TORQUE_STALL 1.67
+#define TORQUE_FREE_SPEED (100 * 2 * SIM_PI / 60)
+#define SPEED_STALL 1.04
+#define SPEED_FREE_SPEED (160 * 2 * SIM_PI / 60)
+
+//393 PTC fuse (HR30-090, rated 0.9 A hold and 1.8 A trip): the current a typical part carries
+//indefinitely, its thermal time constant, and temperatures in a warm pit
+#define PTC_HOLD_AMPS 1.1
+#define PTC_TAU 60.0
+#define PTC_AMBIENT 30.0
+#define PTC_TRIP 100.0
+#define PTC_RESET 85.0
+
+//Battery: open circuit voltage when full, internal resistance, and capacity
+#define BATTERY_FULL 8.1
+#define BATTERY_EMPTY 7.0
+#define BATTERY_RESISTANCE 0.05
+#define BATTERY_AMP_HOURS 3.0
+#define BACKUP_VOLTS 9.0
+
+//Flywheel: four high speed motors geared up 6:1 to the encoder shaft
+#define FLYWHEEL_GEAR 6.0
+#define FLYWHEEL_INERTIA 0.017
+#define FLYWHEEL_DRAG 0.0002
+#define FLYWHEEL_SHOT_LOSS 0.15
+
+//Drive: two torque motors per side straight onto 4 inch wheels
+#define WHEEL_RADIUS 0.0508
+#define TRACK_WIDTH 0.36
+#define SIDE_MASS 3.5
+#define ROLLING_FORCE 2.0
+#define ROLLING_DAMPING 4.0
+
+//Quadrature encoders count 360 ticks per revolution
+#define ENCODER_TICKS 360
+
+//Balls: push time to fire the staged ball, conveyor size, and pickup spacing
+#define BALL_FEED_TIME 0.2
+#define BALL_CAPACITY 4
+#define BALL_PICKUP_DIST 0.3
+//Limit switches on the conveyor: how long the next ball takes to climb to the top switch after
+//a shot, and how long a ball entering holds the bottom switch down
+#define BALL_CLIMB_TIME 0.08
+#define BALL_ENTRY_TIME 0.05
+#define BALL_PIN 11
+//Line trackers on the conveyor (ball.h): readings with and without a ball in front, and noise
+#define TRACKER_TOP 1
+#define TRACKER_ENTRY 2
+#define TRACKER_EMPTY 2900
+#define TRACKER_BALL 600
+#define TRACKER_NOISE 40
+
+typedef enum {MOTOR_NONE, MOTOR_LEFT, MOTOR_RIGHT, MOTOR_FLYWHEEL, MOTOR_INTAKE,
+  MOTOR_BALL} MotorLoad;
+
+typedef struct {
+  MotorLoad load;
+  int direction;  //+1 if a positive command pushes the mechanism forward
+  bool speed;     //High speed gearing
+} MotorWiring;
+
+//Port 1 to 10, as in auto.c; front right (7) is mounted the other way round
+static const MotorWiring wiring[11] = {
+  {MOTOR_NONE, 0, false},
+  {MOTOR_LEFT, 1, false},      //backLeftDrive
+  {MOTOR_FLYWHEEL, 1, true},   //flywheelTwo
+  {MOTOR_FLYWHEEL, 1, true},   //flywheelThree
+  {MOTOR_LEFT, 1, false},      //frontLeftDrive
+  {MOTOR_INTAKE, 1, false},    //intake
+  {MOTOR_RIGHT, 1, false},     //backRightDrive
+  {MOTOR_RIGHT, -1, false},    //frontRightDrive
+  {MOTOR_FLYWHEEL, 1, true},   //flywheelFour
+  {MOTOR_FLYWHEEL, 1, true},   //flywheelOne
+  {MOTOR_BALL, 1, false},      //ballControl
+};
+
+SimState sim;
+
+static double ampHours;
+static double climbTime;  //Seconds until the next ball reaches the top switch
+static double entryTime;  //Seconds a new ball stays in front of the entry tracker
+static unsigned int noise; //Noise generator state, fixed so runs repeat exactly
+
+//Returns the motor torque for a command at a given mechanism speed in rad/s of the motor
+static double simMotor(int command, double speed, bool highSpeed, double *amps) {
+  double stall = highSpeed ? SPEED_STALL : TORQUE_STALL;
+  double free = highSpeed ? SPEED_FREE_SPEED : TORQUE_FREE_SPEED;
+  double emf = (MOTOR_VOLTS - MOTOR_FREE_AMPS * MOTOR_RESISTANCE) / free;
+  double current;
+
+  if(command > 127) {
+    command = 127;
+  } else if(command < -127) {
+    command = -127;
+  }
+  if(command == 0 || !sim.enabled) { //Motor controllers coast at zero
+    *amps = 0;
+    return 0;
+  }
+  current = (command / 127.0 * sim.battery - emf * speed) / MOTOR_RESISTANCE;
+  *amps = fabs(current);
+  return current * stall / MOTOR_STALL_AMPS;
+}
+
+//Friction torque of an unpowered gearbox, opposing motion
+static double simFriction(double speed, bool highSpeed) {
+  double stall = highSpeed ? SPEED_STALL : TORQUE_STALL;
+  double friction = MOTOR_FREE_AMPS * stall / MOTOR_STALL_AMPS;
+
+  return speed > 0 ? -friction : (speed < 0 ? friction : 0);
+}
+
+//Integrates one drive side, with static friction holding it until the motors beat it
+static void simSide(double force, double *velocity, double *position) {
+  double resist = ROLLING_FORCE + ROLLING_DAMPING * fabs(*velocity);
+  double next;
+
+  if(*velocity == 0 && fabs(force) <= ROLLING_FORCE) {
+    return;
+  }
+  if(*velocity > 0 || (*velocity == 0 && force > 0)) {
+    force -= resist;
+  } else {
+    force += resist;
+  }
+  next = *velocity + force / SIDE_MASS * SIM_DT;
+  if((*velocity > 0 && next < 0) || (*velocity < 0 && next > 0)) {
+    next = 0; //Friction stops the side rather than reversing it
+  }
+  *velocity = next;
+  *position += next * SIM_DT;
+}
+
+//Heats or cools a port's PTC fuse for one step of current, opening and resetting it
+static void simPtc(int port, double amps) {
+  double rise = (PTC_TRIP - PTC_AMBIENT) * (amps / PTC_HOLD_AMPS) * (amps / PTC_HOLD_AMPS);
+
+  sim.ptc[port] += (PTC_AMBIENT + rise - sim.ptc[port]) / PTC_TAU * SIM_DT;
+  if(!sim.tripped[port] && sim.ptc[port] >= PTC_TRIP) {
+    sim.tripped[port] = true;
+    sim.ptcTrips++;
+  } else if(sim.tripped[port] && sim.ptc[port] <= PTC_RESET) {
+    sim.tripped[port] = false;
+  }
+}
+
+void simPhysicsInit() {
+  int port;
+
+  memset(&sim, 0, sizeof(sim));
+  ampHours = 0;
+  climbTime = 0;
+  entryTime = 0;
+  noise = 1;
+  sim.battery = BATTERY_FULL;
+  sim.backup = BACKUP_VOLTS;
+  for(port = 1; port <= 10; port++) {
+    sim.ptc[port] = PTC_AMBIENT;
+  }
+}
+
+static void simSwitch(unsigned char pin, bool pressed) {
+  if(sim.digital[pin] == pressed) {
+    simDigitalSet(pin, !pressed);
+  }
+}
+
+//Line tracker reading with a little repeatable noise
+static int simTracker(bool ball) {
+  noise = noise * 1103515245u + 12345u;
+  return (ball ? TRACKER_BALL : TRACKER_EMPTY) + (int)(noise >> 16) % (2 * TRACKER_NOISE + 1) -
+    TRACKER_NOISE;
+}
+
+void simPhysicsStep() {
+  double amps;
+  double total = 0;
+  double torque = 0;
+  double leftForce = 0;
+  double rightForce = 0;
+  double flywheelMotor = sim.flywheelSpeed / FLYWHEEL_GEAR;
+  double leftMotor = sim.leftVel / WHEEL_RADIUS;
+  double rightMotor = sim.rightVel / WHEEL_RADIUS;
+  double forward;
+  double next;
+  int port;
+  int command;
+  const MotorWiring *w;
+
+  for(port = 1; port <= 10; port++) {
+    w = &wiring[port];
+    command = sim.tripped[port] ? 0 : sim.motor[port] * w->direction; //An open fuse coasts
+    switch(w->load) {
+    case MOTOR_FLYWHEEL:
+      torque += simMotor(command, flywheelMotor, w->speed, &amps) +
+        simFriction(flywheelMotor, w->speed);
+      break;
+    case MOTOR_LEFT:
+      leftForce += simMotor(command, leftMotor, w->speed, &amps) / WHEEL_RADIUS;
+      break;
+    case MOTOR_RIGHT:
+      rightForce += simMotor(command, rightMotor, w->speed, &amps) / WHEEL_RADIUS;
+      break;
+    case MOTOR_INTAKE:
+    case MOTOR_BALL: //Lightly loaded, so they draw about free current
+      simMotor(command, command / 127.0 * sim.battery / MOTOR_VOLTS * TORQUE_FREE_SPEED,
+        w->speed, &amps);
+      break;
+    default:
+      amps = 0;
+      break;
+    }
+    simPtc(port, amps);
+    total += amps;
+  }
+
+  //Battery sags with this step's current next step, and slowly runs down
+  ampHours += total * SIM_DT / 3600;
+  sim.current = total;
+  sim.battery = BATTERY_FULL - (BATTERY_FULL - BATTERY_EMPTY) * ampHours / BATTERY_AMP_HOURS -
+    BATTERY_RESISTANCE * total;
+
+  //Flywheel
+  torque = torque / FLYWHEEL_GEAR - FLYWHEEL_DRAG * sim.flywheelSpeed;
+  next = sim.flywheelSpeed + torque / FLYWHEEL_INERTIA * SIM_DT;
+  if((sim.flywheelSpeed > 0 && next < 0) || (sim.flywheelSpeed < 0 && next > 0)) {
+    next = 0; //Friction stops the flywheel rather than reversing it
+  }
+  sim.flywheelSpeed = next;
+  sim.flywheelTicks += sim.flywheelSpeed * SIM_DT * ENCODER_TICKS / (2 * SIM_PI);
+
+  //Drive
+  simSide(leftForce, &sim.leftVel, &sim.leftPos);
+  simSide(rightForce, &sim.rightVel, &sim.rightPos);
+  forward = (sim.leftVel + sim.rightVel) / 2;
+  sim.heading += (sim.leftVel - sim.rightVel) / TRACK_WIDTH * SIM_DT;
+  sim.x += forward * cos(sim.heading) * SIM_DT;
+  sim.y += forward * sin(sim.heading) * SIM_DT;
+
+  //Ball control pushes the staged ball into the flywheel, which loses some speed to it
+  if(sim.enabled && sim.motor[10] > 0 && sim.ballsHeld > 0 && climbTime == 0) {
+    sim.feedTime += sim.motor[10] / 127.0 * SIM_DT;
+    if(sim.feedTime >= BALL_FEED_TIME) {
+      sim.feedTime = 0;
+      sim.ballsHeld--;
+      sim.ballsFired++;
+      sim.flywheelSpeed *= 1 - FLYWHEEL_SHOT_LOSS;
+      climbTime = BALL_CLIMB_TIME;
+    }
+  } else if(sim.motor[10] < 0) {
+    sim.feedTime = 0;
+  }
+
+  //Driving forward with the intake running picks balls up off the floor
+  if(sim.enabled && sim.motor[5] > 64 && forward > 0.05 && sim.fieldBalls > 0 &&
+      sim.ballsHeld < BALL_CAPACITY) {
+    sim.pickupDist += forward * SIM_DT;
+    if(sim.pickupDist >= BALL_PICKUP_DIST) {
+      sim.pickupDist = 0;
+      sim.fieldBalls--;
+      sim.ballsHeld++;
+      sim.ballsPicked++;
+      entryTime = BALL_ENTRY_TIME;
+    }
+  }
+
+  //The switch reads LOW while pressed; changing it fires the robot's pin interrupt
+  climbTime = climbTime > SIM_DT ? climbTime - SIM_DT : 0;
+  entryTime = entryTime > SIM_DT ? entryTime - SIM_DT : 0;
+  simSwitch(BALL_PIN, sim.ballsHeld > 0 && climbTime == 0);
+  if(!sim.stuck[TRACKER_TOP]) {
+    sim.analog[TRACKER_TOP] = simTracker(sim.ballsHeld > 0 && climbTime == 0);
+  }
+  if(!sim.stuck[TRACKER_ENTRY]) {
+    sim.analog[TRACKER_ENTRY] = simTracker(entryTime > 0);
+  }
+}
+
+int simEncoderTicks(unsigned char port) {
+  switch(port) {
+  case 1: //speedEnc
+    return (int)floor(sim.flywheelTicks);
+  case 3: //left, mounted backwards so init.c reverses it
+    return -(int)floor(sim.leftPos / (2 * SIM_PI * WHEEL_RADIUS) * ENCODER_TICKS);
+  case 5: //right, likewise
+    return -(int)floor(sim.rightPos / (2 * SIM_PI * WHEEL_RADIUS) * ENCODER_TICKS);
+  default:
+    return 0;
+  }
+}
@@ -0,0 +1,35 @@
+/** @file prosnames.h
+ * @brief Renames for PROS API names that collide with the host C library
+ *
+ * Forced into every robot source and api.c with -include. API.h declares its own FILE, stdio
+ * functions and wait(), which would otherwise replace the host's versions at link time and
+ * break the simulator's own output.
+ */
+
+#ifndef PROSNAMES_H_
+
+#define PROSNAMES_H_
+
+#define FILE prosFILE
+#define fclose prosFclose
+#define feof prosFeof
+#define fflush prosFflush
+#define fgetc prosFgetc
+#define fgets prosFgets
+#define fopen prosFopen
+#define fputc prosFputc
+#define fputs prosFputs
+#define fread prosFread
+#define fseek prosFseek
+#define ftell prosFtell
+#define fwrite prosFwrite
+#define getchar prosGetchar
+#define putchar prosPutchar
+#define puts prosPuts
+#define fprintf prosFprintf
+#define printf prosPrintf
+#define snprintf prosSnprintf
+#define sprintf prosSprintf
+#define wait prosWait
+
+#endif
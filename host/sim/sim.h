@@ -0,0 +1,264 @@
+/** @file sim.h
+ * @brief Header file shared by the host simulator modules
+ *
+ * The simulator is split so that only api.c sees API.h: the kernel, physics and runner use
+ * the real C library, whose stdio names collide with the PROS ones.
+ */
+
+#ifndef SIM_H_
+
+#define SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// -------------------- Kernel (kernel.c) --------------------
+
+/**
+ * Most tasks that can exist at once.
+ */
+#define SIM_MAX_TASKS 32
+
+typedef void (*SimTaskFn)(void *);
+
+/**
+ * Creates a task. Tasks are coroutines: they only give up the processor by sleeping.
+ *
+ * @param fn the task body
+ * @param arg passed to fn
+ * @param priority higher runs first when several tasks wake at the same time
+ * @return the task id, or -1 if there is no room
+ */
+int simTaskCreate(SimTaskFn fn, void *arg, unsigned int priority);
+/**
+ * Removes a task that is not the one running.
+ *
+ * @param id the task id
+ */
+void simTaskKill(int id);
+/**
+ * @param id the task id
+ * @return true if the task has not returned or been killed
+ */
+bool simTaskAlive(int id);
+/**
+ * Ends the running task, as if its function had returned.
+ */
+void simTaskExit();
+/**
+ * @return the id of the running task, or -1 outside of any task
+ */
+int simTaskCurrent();
+/**
+ * @param id the task id
+ * @return the task state, numbered as TASK_DEAD to TASK_SUSPENDED in API.h
+ */
+unsigned int simTaskState(int id);
+/**
+ * @return the number of live tasks
+ */
+int simTaskCount();
+/**
+ * @param id the task id
+ * @return the task's priority
+ */
+unsigned int simTaskPriority(int id);
+/**
+ * Sets a task's priority.
+ *
+ * @param id the task id
+ * @param priority the new priority
+ */
+void simTaskSetPriority(int id, unsigned int priority);
+/**
+ * Suspends or resumes a task.
+ *
+ * @param id the task id
+ * @param suspended true to suspend
+ */
+void simTaskSuspend(int id, bool suspended);
+/**
+ * Puts the running task to sleep until an absolute time. Wake times in the past just let
+ * other due tasks run first.
+ *
+ * @param wake the wake time in microseconds
+ */
+void simSleepUntil(uint64_t wake);
+/**
+ * Wakes a sleeping task now, as a semaphore or mutex does for its waiters.
+ *
+ * @param id the task id
+ */
+void simTaskWake(int id);
+/**
+ * @return the virtual time in microseconds since power on
+ */
+uint64_t simNow();
+/**
+ * Runs tasks and physics until an absolute time.
+ *
+ * @param end the time to stop at in microseconds
+ */
+void simRunUntil(uint64_t end);
+
+// -------------------- Physics (physics.c) --------------------
+
+/**
+ * Physics step in microseconds.
+ */
+#define SIM_STEP 1000
+
+/**
+ * Everything the robot can sense or drive.
+ */
+typedef struct {
+  bool enabled;
+  bool autonomous;
+  int motor[11];        // Commands per port, 1 to 10
+  bool digital[13];     // Input levels per digital pin, 1 to 12
+  int analog[9];        // Raw readings per analog channel, 1 to 8
+  bool stuck[9];        // Analog channels frozen at their reading, a failed sensor
+  int joyAxis[7];       // Joystick 1 axes, 1 to 6
+  int joyButtons;       // Joystick 1 groups 5 to 8, four JOY_* bits per group from group 5
+  int lcdButtons;       // LCD_BTN_* bits held down
+  double battery;       // Main battery terminal voltage
+  double backup;        // Backup battery voltage
+  double current;       // Total motor current in amps
+  double flywheelSpeed; // Flywheel encoder shaft speed in rad/s
+  double flywheelTicks; // Flywheel encoder position in ticks
+  double leftPos;       // Distance travelled by each side in metres
+  double rightPos;
+  double leftVel;       // Speed of each side in m/s
+  double rightVel;
+  double x;             // Field position in metres and heading in radians
+  double y;
+  double heading;
+  double range;         // Distance to the goal in metres, for ultrasonics
+  int ballsHeld;        // Balls in the conveyor
+  int ballsFired;
+  int ballsPicked;
+  int fieldBalls;       // Balls left on the floor to pick up
+  double feedTime;      // Seconds the ball control has been pushing the staged ball
+  double pickupDist;    // Metres driven with the intake running since the last pickup
+  double ptc[11];       // PTC fuse temperature per motor port in degrees C, 1 to 10
+  bool tripped[11];     // PTC fuses open per motor port, 1 to 10
+  int ptcTrips;         // Times any PTC fuse opened
+} SimState;
+
+extern SimState sim;
+
+/**
+ * Resets the robot to rest with a full battery.
+ */
+void simPhysicsInit();
+/**
+ * Advances the physics by SIM_STEP.
+ */
+void simPhysicsStep();
+/**
+ * Reads a quadrature encoder by its top port.
+ *
+ * @param port the top port of the encoder
+ * @return the raw tick count
+ */
+int simEncoderTicks(unsigned char port);
+
+// -------------------- PROS API (api.c) --------------------
+
+/**
+ * Most files the simulated flash holds.
+ */
+#define SIM_MAX_FILES 16
+
+/**
+ * Drives a digital input, running its interrupt handler on a matching edge.
+ *
+ * @param pin the pin from 1 to 12
+ * @param level the new input level
+ */
+void simDigitalSet(unsigned char pin, bool level);
+/**
+ * Stores a file in the simulated flash, replacing any file of the same name.
+ *
+ * @param name the file name, truncated to eight characters as on the robot
+ * @param data the contents
+ * @param length the number of bytes
+ * @return false if the flash is full
+ */
+bool simFileSet(const char *name, const void *data, unsigned int length);
+/**
+ * Lists the simulated flash.
+ *
+ * @param index the file index from 0
+ * @param name set to the file name
+ * @param length set to the file length
+ * @return the file contents, or NULL past the last file
+ */
+const void *simFileGet(unsigned int index, const char **name, unsigned int *length);
+
+// -------------------- Metrics (metrics.c) --------------------
+
+/**
+ * A control quality measurement over the run so far.
+ */
+typedef struct {
+  const char *name;
+  double value;
+  bool valid; // False until the run has done what the metric measures
+} SimMetric;
+
+/**
+ * Starts sampling the robot for metrics. Call once initialize() has returned.
+ *
+ * @param priority the sampler's kernel priority
+ */
+void simMetricsStart(unsigned int priority);
+/**
+ * Notes that autonomous() returned.
+ */
+void simMetricsAutonomousDone();
+/**
+ * Lists the metrics.
+ *
+ * @param index the metric index from 0
+ * @return the metric, or NULL past the last one
+ */
+const SimMetric *simMetricsGet(unsigned int index);
+
+// -------------------- Host I/O (main.c) --------------------
+
+/**
+ * Receives bytes the robot writes to a serial port or stdout.
+ *
+ * @param port 1 or 2 for the UARTs, 3 for stdout
+ * @param data the bytes
+ * @param length the number of bytes
+ */
+void simSerialWrite(int port, const void *data, unsigned int length);
+/**
+ * Receives a changed LCD line.
+ *
+ * @param line 1 or 2
+ * @param text the new line
+ */
+void simLcdWrite(int line, const char *text);
+/**
+ * Supplies bytes for the robot to read from a serial port or stdin.
+ *
+ * @param port 1 or 2 for the UARTs, 3 for stdin
+ * @return the next byte, or -1 if none is waiting
+ */
+int simSerialRead(int port);
+/**
+ * @param port 1 or 2 for the UARTs, 3 for stdin
+ * @return the number of bytes waiting for the robot to read
+ */
+unsigned int simSerialAvailable(int port);
+/**
+ * Reports a fatal misuse of the simulated API and stops the run.
+ *
+ * @param message what went wrong
+ */
+void simFatal(const char *message);
+
+#endif
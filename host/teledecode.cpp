@@ -0,0 +1,125 @@
+/** @file teledecode.cpp
+ * @brief Host decoder for the binary telemetry stream
+ *
+ * Reads the raw uart2 byte stream from a file or stdin, splits it on frame delimiters, checks
+ * each frame and writes one CSV row per TelemetryRecord to stdout. A summary of bad frames,
+ * frames lost on the wire (sequence gaps) and records dropped on the robot (the record's
+ * dropped count) goes to stderr.
+ *
+ * Usage: teledecode [capture.bin] > capture.csv
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "frame.h"
+#include "telemetry.h"
+
+namespace {
+
+struct Counters {
+  unsigned long frames = 0;
+  unsigned long badFrames = 0;
+  unsigned long sequenceGaps = 0;
+  unsigned long robotDropped = 0;
+  unsigned long wireLost = 0;
+};
+
+void printHeader() {
+  std::printf("time_ms,sequence,enabled,autonomous,ready,unjamming,target_speed,speed,flywheel,"
+    "left_drive,right_drive,intake,ball_control,joy_x,joy_y,battery_mv,loop_us,dropped,"
+    "sample_cycles,step_cycles,flush_cycles,jams\n");
+}
+
+void printRecord(const TelemetryRecord &r) {
+  std::printf("%lu,%u,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%u,%u,%u,%u,%u,%u,%u\n",
+    (unsigned long)r.time, (unsigned)r.sequence, (r.flags & TELEMETRY_ENABLED) ? 1 : 0,
+    (r.flags & TELEMETRY_AUTONOMOUS) ? 1 : 0, (r.flags & TELEMETRY_READY) ? 1 : 0,
+    (r.flags & TELEMETRY_UNJAMMING) ? 1 : 0,
+    r.targetSpeed, r.speed, r.flywheel, r.leftDrive, r.rightDrive, r.intake, r.ballControl,
+    r.joyX, r.joyY, (unsigned)r.battery, (unsigned)r.loopTime, (unsigned)r.dropped,
+    (unsigned)r.sampleCycles, (unsigned)r.stepCycles, (unsigned)r.flushCycles, (unsigned)r.jams);
+}
+
+class Decoder {
+public:
+  explicit Decoder(Counters &counters) : counters_(counters) {}
+
+  void feed(unsigned char byte) {
+    if(byte != 0) {
+      if(frame_.size() < FRAME_SIZE(FRAME_MAX_PAYLOAD)) {
+        frame_.push_back(byte);
+      } else {
+        overflow_ = true;
+      }
+      return;
+    }
+    if(!frame_.empty() || overflow_) {
+      finish();
+    }
+    frame_.clear();
+    overflow_ = false;
+  }
+
+private:
+  void finish() {
+    TelemetryRecord record;
+    unsigned char payload[FRAME_SIZE(FRAME_MAX_PAYLOAD)];
+    int length = overflow_ ? -1 : frameDecode(frame_.data(), frame_.size(), payload);
+
+    if(length != (int)sizeof(record) || payload[0] != TELEMETRY_VERSION) {
+      counters_.badFrames++;
+      return;
+    }
+    std::memcpy(&record, payload, sizeof(record));
+    if(haveSequence_) {
+      counters_.sequenceGaps += (uint16_t)(record.sequence - lastSequence_ - 1);
+    } else {
+      firstDropped_ = record.dropped;
+    }
+    haveSequence_ = true;
+    lastSequence_ = record.sequence;
+    //Dropped records still used up a sequence number, so the rest of the gap was the wire
+    counters_.robotDropped = (uint16_t)(record.dropped - firstDropped_);
+    counters_.wireLost = counters_.sequenceGaps - counters_.robotDropped;
+    counters_.frames++;
+    printRecord(record);
+  }
+
+  Counters &counters_;
+  std::vector<unsigned char> frame_;
+  bool overflow_ = false;
+  bool haveSequence_ = false;
+  uint16_t lastSequence_ = 0;
+  uint16_t firstDropped_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::FILE *in = stdin;
+  Counters counters;
+  Decoder decoder(counters);
+  unsigned char buffer[4096];
+  std::size_t length;
+
+  if(argc > 1 && !(in = std::fopen(argv[1], "rb"))) {
+    std::perror(argv[1]);
+    return 1;
+  }
+  printHeader();
+  while((length = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+    for(std::size_t i = 0; i < length; i++) {
+      decoder.feed(buffer[i]);
+    }
+  }
+  if(in != stdin) {
+    std::fclose(in);
+  }
+
+  std::fprintf(stderr, "teledecode: %lu frames, %lu bad frames, %lu lost on the wire, "
+    "%lu dropped on the robot\n", counters.frames, counters.badFrames, counters.wireLost,
+    counters.robotDropped);
+  return 0;
+}
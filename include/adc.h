@@ -0,0 +1,81 @@
+/** @file adc.h
+ * @brief Header file for the oversampled analog acquisition task
+ *
+ * One task reads all BOARD_NR_ADC_PINS channels every ADC_PERIOD, sums ADC_OVERSAMPLE readings
+ * of each and publishes their mean with a timestamp in a shared table. Control code reads the
+ * table instead of calling analogRead() itself, so it gets a value averaged over the last few
+ * milliseconds at the cost of a memory read, whenever its loop happens to get there.
+ *
+ * Channels listed in ADC_INTEGRATING are for sensors whose output is integrated, like a gyro or
+ * accelerometer. They are calibrated at startup and read with analogReadCalibratedHR(), so the
+ * table holds their offset from rest in 1/16 counts and integrating it does not drift with the
+ * round-off of the 12-bit reading.
+ */
+
+#ifndef ADC_H_
+
+#define ADC_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Milliseconds between readings of each channel.
+ */
+#define ADC_PERIOD 1
+/**
+ * Readings averaged into each published value, a power of two. A value is published every
+ * ADC_PERIOD * ADC_OVERSAMPLE milliseconds and averages the readings since the last.
+ */
+#define ADC_OVERSAMPLE 4
+/**
+ * Priority of the acquisition task. It runs for a few microseconds each millisecond, so it sits
+ * with the event dispatcher above every control task to keep its timing exact.
+ */
+#define ADC_PRIORITY TASK_PRIORITY_HIGHEST
+/**
+ * Channels read with analogReadCalibratedHR(), bit n - 1 for channel n. This robot has no
+ * integrating analog sensor yet; the line trackers on 1 and 2 are read raw.
+ */
+#define ADC_INTEGRATING 0x00
+
+/**
+ * One published value.
+ */
+typedef struct {
+  int value;          // Mean reading, as analogRead() or analogReadCalibratedHR() returns it
+  unsigned long time; // millis() of the newest reading in the mean
+} AdcSample;
+
+/**
+ * Calibrates the ADC_INTEGRATING channels, fills the table with one reading of every channel
+ * and starts the acquisition task. Call once from initialize() before anything reads the table;
+ * the robot must sit still if any channel is integrating.
+ */
+void adcInit();
+/**
+ * Reads a channel's latest value.
+ *
+ * @param channel the channel, 1 to BOARD_NR_ADC_PINS
+ * @return the mean of the last ADC_OVERSAMPLE readings, or 0 for an invalid channel
+ */
+int adcGet(unsigned char channel);
+/**
+ * Reads a channel's latest value together with its timestamp. The pair is always from the
+ * same publication.
+ *
+ * @param channel the channel, 1 to BOARD_NR_ADC_PINS
+ * @param sample where to copy the value and timestamp
+ * @return false, leaving sample unchanged, for an invalid channel
+ */
+bool adcSample(unsigned char channel, AdcSample *sample);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
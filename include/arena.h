@@ -0,0 +1,109 @@
+/** @file arena.h
+ * @brief Header file for the static arena allocator
+ *
+ * Every long-lived buffer comes out of one statically sized arena instead of the heap, so RAM
+ * use is fixed at link time and nothing can fragment. The arena is split into named pools
+ * whose sizes are listed in ARENA_POOL_LIST below. Allocation is only allowed while the robot
+ * starts up: initialize() calls arenaFreeze() when it is done, and any allocation after that
+ * fails and counts as a violation instead of costing time in a control path.
+ *
+ * On the robot the arena is the .arena section of firmware/cortex.ld, which the startup code
+ * neither copies nor zeroes; arenaAlloc() clears each block it hands out. The robot image is
+ * also linked with malloc(), calloc() and realloc() wrapped (see LDFLAGS in common.mk), so a
+ * heap call after arenaFreeze() is counted by arenaHeapCalls() rather than going unnoticed.
+ */
+
+#ifndef ARENA_H_
+
+#define ARENA_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Every pool as POOL(id, name, size). Sizes are only expanded in arena.c, so they may name
+ * constants from any module header. Add a line here to give a new module its own pool.
+ */
+#define ARENA_POOL_LIST(POOL) \
+  POOL(ARENA_TELEMETRY, "telemetry", TELEMETRY_RING_SIZE) \
+  POOL(ARENA_BLACKBOX, "blackbox", BLACKBOX_RING_SIZE) \
+  POOL(ARENA_EVENTS, "events", EVENTS_QUEUE_SIZE) \
+  POOL(ARENA_POWER, "power", POWER_LOG_SIZE) \
+  POOL(ARENA_REPLAY, "replay", REPLAY_BUFFER)
+
+#define ARENA_POOL_ID(id, name, size) id,
+/**
+ * Arena pool identifiers.
+ */
+typedef enum {
+  ARENA_POOL_LIST(ARENA_POOL_ID)
+  ARENA_POOLS
+} ArenaPool;
+#undef ARENA_POOL_ID
+
+/**
+ * Alignment of every block in bytes.
+ */
+#define ARENA_ALIGN 8
+
+/**
+ * Allocates a zeroed block from a pool. Only valid before arenaFreeze().
+ *
+ * @param pool the pool to take the block from
+ * @param size the block size in bytes
+ * @return the block, or NULL (counted by arenaViolations()) if the arena is frozen or the pool
+ *         is too small
+ */
+void *arenaAlloc(ArenaPool pool, unsigned int size);
+/**
+ * Ends start-up allocation. Call once at the end of initialize(). Prints the pool report to
+ * stdout.
+ */
+void arenaFreeze();
+/**
+ * @return true once arenaFreeze() has been called
+ */
+bool arenaFrozen();
+/**
+ * Counts allocations that failed, either after arenaFreeze() or because a pool was too small.
+ * Anything but zero is a bug.
+ *
+ * @return the number of failed allocations since startup
+ */
+unsigned int arenaViolations();
+/**
+ * Counts heap calls (malloc(), calloc() and realloc()) made after arenaFreeze() by anything
+ * linked into the robot image, PROS included. They still allocate; the count is how a heap call
+ * left in a control path shows up. Always 0 off the ARM toolchain, where the heap is the host's.
+ *
+ * @return the number of heap calls since arenaFreeze()
+ */
+unsigned int arenaHeapCalls();
+/**
+ * Reads the peak use of a pool. Blocks are never freed, so this is also its current use.
+ *
+ * @param pool the pool
+ * @return the bytes handed out from the pool, including alignment
+ */
+unsigned int arenaUsed(ArenaPool pool);
+/**
+ * @param pool the pool
+ * @return the pool size in bytes
+ */
+unsigned int arenaSize(ArenaPool pool);
+/**
+ * Prints one line per pool with its use and size, then the violation and heap call counts.
+ *
+ * @param out the stream to print to, usually stdout
+ */
+void arenaReport(FILE *out);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/** @file ball.h
+ * @brief Header file for analog ball presence sensing
+ *
+ * Two line trackers watch the conveyor: one at the top where a ball waits for ball control,
+ * one at the entry from the intake. A sampler task reads both at a fixed rate and turns them
+ * into clean presence flags with hysteresis, so shot gating can wait for a ball instead of
+ * spinning ball control over an empty conveyor. The switch the staged ball holds down (see
+ * events.h) backs up the top tracker.
+ */
+
+#ifndef BALL_H_
+
+#define BALL_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Line tracker at the top of the conveyor, in front of the staged ball.
+ */
+#define BALL_TOP_PORT 1
+/**
+ * Line tracker at the conveyor entry.
+ */
+#define BALL_ENTRY_PORT 2
+/**
+ * Sample period in milliseconds.
+ */
+#define BALL_PERIOD 5
+/**
+ * Priority of the sampler task, level with the flywheel task.
+ */
+#define BALL_PRIORITY (TASK_PRIORITY_DEFAULT + 2)
+/**
+ * Drop below the empty reading, in ADC counts, that means a ball has arrived. A ball reflects
+ * far more than the dark conveyor, so trackers read lower with a ball in front.
+ */
+#define BALL_ON_DROP 800
+/**
+ * Drop below which the ball has gone; the gap to BALL_ON_DROP is the hysteresis.
+ */
+#define BALL_OFF_DROP 400
+/**
+ * Lowest believable empty reading. A calibration below it had a ball in front of the tracker
+ * (a preload, say) and BALL_DEFAULT_EMPTY is used instead.
+ */
+#define BALL_EMPTY_MIN 2000
+/**
+ * Typical empty reading, used when calibration cannot be trusted.
+ */
+#define BALL_DEFAULT_EMPTY 2900
+/**
+ * Milliseconds ball control may have stopped before the ball is seen leaving and it still
+ * counts as a shot. The shot itself slows the flywheel out of its ready window, which can stop
+ * ball control a sample before the tracker clears.
+ */
+#define BALL_FIRE_WINDOW 50
+/**
+ * Balls loaded into the conveyor before a match.
+ */
+#define BALL_PRELOADS 4
+
+/**
+ * Calibrates the trackers, subscribes to the staged ball switch and starts the sampler task.
+ * Call once from initialize(), after adcInit() and before eventsInit(), with the conveyor
+ * empty in front of both trackers if possible.
+ */
+void ballInit();
+/**
+ * @return true while a ball is staged at the top of the conveyor, by the top tracker or the
+ *         staged ball switch
+ */
+bool ballPresent();
+/**
+ * Counts balls in the conveyor: entries at the bottom minus balls fired from the top. It is
+ * never below one while a ball is staged.
+ *
+ * @return the number of balls in the conveyor
+ */
+int ballCount();
+/**
+ * Sets the ball count, for preloads the sensors never saw enter.
+ *
+ * @param count the number of balls in the conveyor
+ */
+void ballSetCount(int count);
+/**
+ * @return milliseconds since a ball last arrived at either tracker
+ */
+unsigned long ballIdleTime();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,93 @@
+/** @file blackbox.h
+ * @brief Header file for the post-match black-box logger
+ *
+ * While the robot is enabled, a recorder task delta encodes a TelemetryRecord every
+ * BLACKBOX_PERIOD ms into a RAM ring. File writes stall user tasks, so the ring is only
+ * written to flash once the robot is disabled, one file per enabled stretch, rotating through
+ * BLACKBOX_FILES files. PROS has one file open for writing at a time, so a write can find the
+ * handle taken by calib.h or replay.h; the ring is then kept and the write retried, and a
+ * stretch that starts before it succeeds lands in the same file. host/bbexpand turns the
+ * files back into CSV.
+ *
+ * The file layout is shared with the host tool, so this file does not depend on API.h.
+ */
+
+#ifndef BLACKBOX_H_
+
+#define BLACKBOX_H_
+
+#include <stdint.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Sample period in milliseconds.
+ */
+#define BLACKBOX_PERIOD 50
+/**
+ * RAM ring size in bytes. At about five bytes per sample this holds well over a two minute
+ * match; samples that do not fit are counted and dropped. Taken from the arena.
+ */
+#define BLACKBOX_RING_SIZE 16384
+/**
+ * Number of files in the rotation, named "bb0", "bb1", ...
+ */
+#define BLACKBOX_FILES 4
+/**
+ * File magic, also the layout version.
+ */
+#define BLACKBOX_MAGIC "BBX1"
+
+/**
+ * Sample fields in delta.h field order. The busiest fields come first so their change bits fit
+ * in the first mask byte.
+ */
+typedef enum {
+  BLACKBOX_TIME = 0,
+  BLACKBOX_SPEED,
+  BLACKBOX_FLYWHEEL,
+  BLACKBOX_BATTERY,
+  BLACKBOX_LEFT_DRIVE,
+  BLACKBOX_RIGHT_DRIVE,
+  BLACKBOX_JOY_X,
+  BLACKBOX_JOY_Y,
+  BLACKBOX_TARGET_SPEED,
+  BLACKBOX_INTAKE,
+  BLACKBOX_BALL_CONTROL,
+  BLACKBOX_FLAGS,
+  BLACKBOX_LOOP_TIME,
+  BLACKBOX_FIELDS
+} BlackboxField;
+
+/**
+ * File header, followed by length bytes of delta.h encoded samples.
+ */
+typedef struct __attribute__((packed)) {
+  char magic[4];     // BLACKBOX_MAGIC
+  uint32_t session;  // Increases by one per file, across reboots
+  uint16_t period;   // BLACKBOX_PERIOD when recorded
+  uint16_t fields;   // BLACKBOX_FIELDS when recorded
+  uint32_t samples;  // Samples stored
+  uint32_t dropped;  // Samples lost to a full ring
+  uint32_t length;   // Encoded bytes after the header
+} BlackboxHeader;
+
+/**
+ * Finds the newest file in the rotation and starts the recorder task. Call once from
+ * initialize(), after telemetryInit().
+ */
+void blackboxInit();
+/**
+ * Writes every stored file, oldest first, to stdout exactly as stored, so a terminal capture
+ * can be fed straight to host/bbexpand. Only call this while the robot is disabled.
+ */
+void blackboxDump();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+/** @file calib.h
+ * @brief Header file for sensor calibration persisted in flash
+ *
+ * Calibrating an analog sensor means sitting still for half a second of samples at every boot.
+ * Instead each resting baseline is kept in the flash file CALIB_FILE: initialize() loads it,
+ * and a sensor asking for its baseline gets the stored one after a quick sanity sample agrees
+ * with it. Only a missing, corrupt or disagreeing baseline is measured again, and the file is
+ * rewritten once start-up is done.
+ *
+ * Holding the left LCD button while the robot starts ignores the file and measures everything.
+ */
+
+#ifndef CALIB_H_
+
+#define CALIB_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Flash file holding the calibration.
+ */
+#define CALIB_FILE "calib"
+/**
+ * File magic, also the layout version.
+ */
+#define CALIB_MAGIC "CAL1"
+/**
+ * Readings, 1 ms apart, averaged into a new baseline; the same as analogCalibrate().
+ */
+#define CALIB_SAMPLES 512
+/**
+ * Readings, 1 ms apart, averaged for the sanity check of a stored baseline.
+ */
+#define CALIB_CHECK_SAMPLES 16
+
+/**
+ * Loads CALIB_FILE. Call once from initialize() before any sensor asks for its baseline.
+ *
+ * @param force true to ignore the file and measure every baseline again
+ * @return true if the file was loaded and passed its checks
+ */
+bool calibLoad(bool force);
+/**
+ * Gets the resting baseline of an analog channel: the stored one if it is there and a quick
+ * sample falls inside the given window around it, otherwise a fresh measurement, which is
+ * stored for next time. The window lets a sensor say which way a disagreement is explained by
+ * something other than a bad baseline, like a ball in front of a line tracker.
+ *
+ * @param channel the analog channel, 1 to BOARD_NR_ADC_PINS
+ * @param below how far, in counts, the sample may read under the stored baseline
+ * @param above how far, in counts, the sample may read over the stored baseline
+ * @return the baseline in 1/16 counts, the units of analogReadCalibratedHR()
+ */
+int calibAnalog(unsigned char channel, int below, int above);
+/**
+ * Writes CALIB_FILE if any baseline was measured since it was loaded. Call once at the end of
+ * initialize(). If the file cannot be opened, a low priority task tries again every half
+ * second while the robot is disabled until it is written.
+ */
+void calibSave();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+/** @file console.h
+ * @brief Header file for the serial tuning console
+ *
+ * A low priority task polls a serial port for command lines and answers on the same port:
+ *
+ *   get NAME         prints "NAME value"
+ *   set NAME VALUE   sets a parameter within its bounds and prints it back
+ *   list             prints every parameter with its bounds
+ *   save             writes the parameters to flash so the next boot loads them; disabled only
+ *   arena            prints the arena report (see arena.h), heap calls since startup included
+ *
+ * Anything else prints an error line starting "error:". The task only reads the bytes already
+ * waiting, so a quiet terminal never holds it up. New values take effect the next time the
+ * control code reads them (see param.h); a flywheel preset, for one, on its next button press.
+ */
+
+#ifndef CONSOLE_H_
+
+#define CONSOLE_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Poll period in milliseconds.
+ */
+#define CONSOLE_PERIOD 50
+/**
+ * Priority of the console task, below everything that moves the robot.
+ */
+#define CONSOLE_PRIORITY (TASK_PRIORITY_DEFAULT - 1)
+/**
+ * Longest command line; longer lines are answered with an error and otherwise ignored.
+ */
+#define CONSOLE_LINE 48
+
+/**
+ * Starts the console task. Call once from initialize().
+ *
+ * @param port the port to take commands from and answer on: stdin for the PC terminal, or
+ *        uart2 on a robot that is not streaming telemetry, whose frames would bury the answers
+ */
+void consoleInit(FILE *port);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,267 @@
+/** @file control.h
+ * @brief Header file for the compile-time control library and its C wrappers
+ *
+ * In C++ this header provides templates whose hardware ports and gains are template
+ * parameters: MotorGroup<ports...>, Encoder<top, bottom, reversed>, Pid<Gains> and
+ * RingBuffer<T, N>. Everything is resolved at compile time, so a MotorGroup::set() is a
+ * straight run of motorSet() calls with constant ports and no tables or indirect calls.
+ *
+ * The robot's own instances live in control.cpp and are exported through the plain C functions
+ * below, which is how autonomous(), operatorControl() and the C tasks reach them: the motor
+ * groups, the flywheel's count history (a RingBuffer) and the replay drift correction (a pair
+ * of Pid controllers).
+ */
+
+#ifndef CONTROL_H_
+
+#define CONTROL_H_
+
+#include <API.h>
+#include "ramfunc.h"
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initializes the drive and flywheel encoders into left, right and speedEnc. Call once from
+ * initialize().
+ */
+void controlInit();
+/**
+ * Drives both sides of the base.
+ *
+ * @param left the left side power, -127 to 127, positive forwards
+ * @param right the right side power, -127 to 127, positive forwards
+ */
+void controlDrive(int left, int right);
+/**
+ * Sets all four flywheel motors. Runs from RAM (see ramfunc.h).
+ *
+ * @param power the flywheel power, -127 to 127
+ */
+RAMFUNC void controlFlywheel(int power);
+/**
+ * Fills the flywheel's count history with the encoder's current count, so the next
+ * controlFlywheelSpeed() reads zero. Call once from the flywheel task before its loop.
+ */
+void controlFlywheelStart();
+/**
+ * Measures the flywheel speed from the count history. Call once every FLYWHEEL_PERIOD. Runs
+ * from RAM (see ramfunc.h).
+ *
+ * @return the counts over the last FLYWHEEL_WINDOW ms
+ */
+RAMFUNC int controlFlywheelSpeed();
+/**
+ * Resets the replay drift correction, for the start of a replay.
+ */
+void controlSteerReset();
+/**
+ * Turns the drive encoders' distance from a recorded checkpoint into joystick offsets that
+ * steer back towards it.
+ *
+ * @param errorLeft the recorded left count minus the current one
+ * @param errorRight the recorded right count minus the current one
+ * @param x where to store the turn offset
+ * @param y where to store the forward offset
+ */
+void controlSteer(int errorLeft, int errorRight, int *x, int *y);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+
+// Templates cannot have C linkage, so the C++ interface sits outside the export block
+namespace control {
+
+/**
+ * A set of motors always driven together. Ports run from 1 to 10; a negative port drives that
+ * motor reversed, for motors mounted the other way round.
+ */
+template<int... Ports> struct MotorGroup;
+
+template<> struct MotorGroup<> {
+  static inline __attribute__((always_inline)) void set(int) {}
+};
+
+template<int Port, int... Rest> struct MotorGroup<Port, Rest...> {
+  static_assert(Port != 0 && Port >= -10 && Port <= 10, "motor ports run from 1 to 10");
+
+  /**
+   * Sets every motor in the group.
+   *
+   * @param power the power, -127 to 127
+   */
+  static inline __attribute__((always_inline)) void set(int power) {
+    motorSet(Port < 0 ? -Port : Port, Port < 0 ? -power : power);
+    MotorGroup<Rest...>::set(power);
+  }
+  /**
+   * Stops every motor in the group.
+   */
+  static inline __attribute__((always_inline)) void stop() {
+    set(0);
+  }
+};
+
+/**
+ * A quadrature encoder on two digital ports. There is one handle per port pair, so every use
+ * of the same Encoder type reads the same sensor.
+ */
+template<unsigned char Top, unsigned char Bottom, bool Reversed> class Encoder {
+  static_assert(Top >= 1 && Top <= 12 && Top != 10, "encoder top port must be 1-12, not 10");
+  static_assert(Bottom >= 1 && Bottom <= 12 && Bottom != 10,
+    "encoder bottom port must be 1-12, not 10");
+  static_assert(Top != Bottom, "encoder ports must differ");
+
+public:
+  /**
+   * Initializes the encoder. Call once from initialize().
+   *
+   * @return the PROS handle, for C code that reads the encoder directly
+   */
+  static ::Encoder init() {
+    handle_ = encoderInit(Top, Bottom, Reversed);
+    return handle_;
+  }
+  /**
+   * @return the counts since the last init() or reset()
+   */
+  static int get() {
+    return encoderGet(handle_);
+  }
+  /**
+   * Zeroes the count.
+   */
+  static void reset() {
+    encoderReset(handle_);
+  }
+
+private:
+  static ::Encoder handle_;
+};
+
+template<unsigned char Top, unsigned char Bottom, bool Reversed>
+::Encoder Encoder<Top, Bottom, Reversed>::handle_ = NULL;
+
+/**
+ * An integer PID controller. Gains is a type with these static constexpr int members:
+ *   kp, ki, kd  the gains scaled by 2^shift
+ *   shift       the fixed point shift of the gains
+ *   limit       the output bound, which also bounds the integral term
+ * For example kp = 896 with shift = 8 is a proportional gain of 3.5.
+ */
+template<class Gains> class Pid {
+  static_assert(Gains::shift >= 0 && Gains::shift < 16, "PID shift must be 0 to 15");
+  static_assert(Gains::limit > 0, "PID limit must be positive");
+
+public:
+  Pid() : integral_(0), last_(0), started_(false) {}
+
+  /**
+   * Forgets the integral and the last error, for a new setpoint or after a pause.
+   */
+  void reset() {
+    integral_ = 0;
+    started_ = false;
+  }
+  /**
+   * Runs one control period.
+   *
+   * @param error the setpoint minus the measurement
+   * @return the output, -limit to limit
+   */
+  int step(int error) {
+    const int integralLimit = Gains::limit << Gains::shift;
+    int output;
+
+    if(!started_) { //No derivative kick on the first period
+      last_ = error;
+      started_ = true;
+    }
+    integral_ = clamp(integral_ + error * Gains::ki, integralLimit);
+    output = (error * Gains::kp + integral_ + (error - last_) * Gains::kd) >> Gains::shift;
+    last_ = error;
+    return clamp(output, Gains::limit);
+  }
+
+private:
+  static int clamp(int value, int limit) {
+    return value > limit ? limit : (value < -limit ? -limit : value);
+  }
+
+  int integral_;
+  int last_;
+  bool started_;
+};
+
+/**
+ * A single producer, single consumer queue of N values, like ring.h but typed and sized at
+ * compile time. One task (or interrupt) may push while another pops, without a mutex. push()
+ * and pop() are always inlined, so a RAMFUNC caller keeps them in RAM with it.
+ */
+template<class T, unsigned int N> class RingBuffer {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuffer size must be a power of two");
+
+public:
+  RingBuffer() : head_(0), tail_(0) {}
+
+  /**
+   * Adds a value.
+   *
+   * @param value the value to copy in
+   * @return false, leaving the queue unchanged, if it is full
+   */
+  inline __attribute__((always_inline)) bool push(const T &value) {
+    unsigned int head = head_;
+
+    if(head - tail_ >= N) {
+      return false;
+    }
+    items_[head & (N - 1)] = value;
+    __asm__ volatile("" ::: "memory"); //Publish the item before the index
+    head_ = head + 1;
+    return true;
+  }
+  /**
+   * Takes the oldest value.
+   *
+   * @param value where to copy it
+   * @return false if the queue is empty
+   */
+  inline __attribute__((always_inline)) bool pop(T &value) {
+    unsigned int tail = tail_;
+
+    if(head_ == tail) {
+      return false;
+    }
+    value = items_[tail & (N - 1)];
+    __asm__ volatile("" ::: "memory"); //Finish reading before giving the slot back
+    tail_ = tail + 1;
+    return true;
+  }
+  /**
+   * @return the number of values queued
+   */
+  unsigned int size() const {
+    return head_ - tail_;
+  }
+  /**
+   * @return true if nothing is queued
+   */
+  bool empty() const {
+    return head_ == tail_;
+  }
+
+private:
+  T items_[N];
+  volatile unsigned int head_; // Values ever pushed, only changed by the producer
+  volatile unsigned int tail_; // Values ever popped, only changed by the consumer
+};
+
+} // namespace control
+
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/** @file delta.h
+ * @brief Header file for the delta plus varint sample codec
+ *
+ * Each sample is a fixed set of integer fields. A sample is stored as a varint bitmask of the
+ * fields that changed since the previous sample, followed by the zigzag varint difference of
+ * each changed field. A tick where only the clock and one sensor moved costs about four bytes.
+ *
+ * Encoder and decoder must start from the same state (deltaReset()), so every stream segment
+ * begins right after a reset.
+ *
+ * This file does not depend on API.h so it also builds for the host tools.
+ */
+
+#ifndef DELTA_H_
+
+#define DELTA_H_
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Most fields one sample can hold.
+ */
+#define DELTA_MAX_FIELDS 16
+/**
+ * Largest encoded sample: a 3 byte mask plus a 5 byte varint per field.
+ */
+#define DELTA_MAX_SIZE (3 + 5 * DELTA_MAX_FIELDS)
+
+/**
+ * Codec state, the previous sample.
+ */
+typedef struct {
+  int previous[DELTA_MAX_FIELDS];
+  int fields;
+} Delta;
+
+/**
+ * Clears the previous sample to all zeros, so the next sample is stored in full.
+ *
+ * @param delta the codec state
+ * @param fields the number of fields per sample, at most DELTA_MAX_FIELDS
+ */
+void deltaReset(Delta *delta, int fields);
+/**
+ * Encodes one sample and makes it the previous sample.
+ *
+ * @param delta the codec state
+ * @param values the sample, delta->fields values
+ * @param out the buffer, at least DELTA_MAX_SIZE bytes
+ * @return the number of bytes written
+ */
+int deltaEncode(Delta *delta, const int *values, unsigned char *out);
+/**
+ * Decodes one sample and makes it the previous sample.
+ *
+ * @param delta the codec state
+ * @param in the encoded bytes
+ * @param length the number of bytes available
+ * @param values the decoded sample, delta->fields values
+ * @return the number of bytes consumed, or -1 if the input is truncated or malformed
+ */
+int deltaDecode(Delta *delta, const unsigned char *in, int length, int *values);
+/**
+ * Writes an unsigned varint, 7 bits per byte with the high bit marking a continuation.
+ *
+ * @param out the buffer, at least 5 bytes
+ * @param value the number to write
+ * @return the number of bytes written
+ */
+int deltaPutVarint(unsigned char *out, unsigned int value);
+/**
+ * Reads an unsigned varint.
+ *
+ * @param in the encoded bytes
+ * @param length the number of bytes available
+ * @param value the decoded number
+ * @return the number of bytes consumed, or -1 if the input is truncated or malformed
+ */
+int deltaGetVarint(const unsigned char *in, int length, unsigned int *value);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+/** @file display.h
+ * @brief Header file for the cached LCD renderer
+ *
+ * Control code posts text and values to a two line frame buffer without formatting anything.
+ * A low priority task renders the frame at DISPLAY_PERIOD and only pushes a line over the
+ * UART when its text actually changed.
+ */
+
+#ifndef DISPLAY_H_
+
+#define DISPLAY_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * LCD render period in milliseconds.
+ */
+#define DISPLAY_PERIOD 100
+/**
+ * Priority of the LCD render task.
+ */
+#define DISPLAY_PRIORITY (TASK_PRIORITY_DEFAULT - 1)
+/**
+ * Characters on one LCD line.
+ */
+#define DISPLAY_WIDTH 16
+
+/**
+ * Starts the LCD render task. Call once from initialize() after lcdInit().
+ *
+ * @param lcdPort the LCD to render to, either uart1 or uart2
+ */
+void displayInit(FILE *lcdPort);
+/**
+ * Shows a fixed string on a line.
+ *
+ * @param line the LCD line to write, either 1 or 2
+ * @param text the string to show; it is not copied and must outlive the post (use literals)
+ */
+void displayText(unsigned char line, const char *text);
+/**
+ * Shows a number followed by a label on a line, like lcdPrint(lcdPort, line, "%d label").
+ *
+ * @param line the LCD line to write, either 1 or 2
+ * @param value the number to show
+ * @param label the string after the number, or NULL; it is not copied (use literals)
+ */
+void displayValue(unsigned char line, int value, const char *label);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+/** @file driver.h
+ * @brief Header file for the driver control step
+ *
+ * operatorControl() reads a DriverInput snapshot from the joystick once per tick and hands it
+ * to driverStep(). Keeping the control logic behind a plain snapshot lets the replay module
+ * feed recorded input through exactly the same code in autonomous().
+ */
+
+#ifndef DRIVER_H_
+
+#define DRIVER_H_
+
+#include <stdbool.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Driver loop period in milliseconds.
+ */
+#define DRIVER_PERIOD 20
+
+/**
+ * Bit offset of each joystick button group in DriverInput.buttons. Each group holds the
+ * JOY_DOWN, JOY_LEFT, JOY_UP and JOY_RIGHT bits of that group.
+ */
+#define DRIVER_GROUP(group) (((group) - 5) * 4)
+
+/**
+ * Joystick deadzone: the drive stays off until an axis passes it, in case the sticks do not
+ * centre. Tunable from the console (see param.h).
+ */
+extern int driverDeadzone;
+
+/**
+ * One tick of driver input.
+ */
+typedef struct {
+  int x;       // Joystick 1 axis 1
+  int y;       // Joystick 1 axis 2
+  int buttons; // Joystick 1 button groups 5 to 8, see DRIVER_GROUP()
+} DriverInput;
+
+/**
+ * Reads the joystick into a snapshot.
+ *
+ * @param input the snapshot to fill
+ */
+void driverRead(DriverInput *input);
+/**
+ * Checks one button in a snapshot.
+ *
+ * @param input the snapshot
+ * @param group the button group, 5 to 8
+ * @param button JOY_DOWN, JOY_LEFT, JOY_UP or JOY_RIGHT
+ * @return true if the button was pressed
+ */
+bool driverButton(const DriverInput *input, unsigned char group, unsigned char button);
+/**
+ * Runs the drive, indexer request and flywheel target logic for one tick.
+ *
+ * @param input the driver input for this tick
+ */
+void driverStep(const DriverInput *input);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+/** @file events.h
+ * @brief Header file for interrupt-driven digital sensor events
+ *
+ * Limit switches are not polled: a pin change interrupt stamps each edge with micros() and
+ * queues it, and a high priority task wakes on a semaphore to hand the edge to whoever
+ * subscribed. A ball reaching a switch is therefore seen within a task switch of the edge,
+ * however slow the loop that eventually acts on it.
+ */
+
+#ifndef EVENTS_H_
+
+#define EVENTS_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Switch pressed (LOW) by the ball staged at the top of the conveyor, under ball control. The
+ * ball sensing in ball.c subscribes to it.
+ */
+#define EVENTS_BALL_PIN 11
+/**
+ * Bytes of queued events, a power of two (32 events). Taken from the arena.
+ */
+#define EVENTS_QUEUE_SIZE 256
+/**
+ * Most subscribers across all pins.
+ */
+#define EVENTS_MAX_HANDLERS 8
+/**
+ * Priority of the event dispatch task, above every control task.
+ */
+#define EVENTS_PRIORITY TASK_PRIORITY_HIGHEST
+
+/**
+ * One edge on a digital input.
+ */
+typedef struct {
+  uint32_t time;    // micros() in the interrupt
+  uint8_t pin;      // Digital port, 1-9 or 11-12
+  uint8_t level;    // The pin level just after the edge, LOW or HIGH
+  uint16_t reserved;
+} Event;
+
+/**
+ * Called from the dispatch task, not the interrupt, for each edge on a subscribed pin. Keep it
+ * short: every other subscriber waits for it.
+ */
+typedef void (*EventHandler)(const Event *event);
+
+/**
+ * Sets the sensor pins to inputs and sets up the queue. Call once from initializeIO().
+ */
+void eventsInitIO();
+/**
+ * Starts the dispatch task and enables the pin interrupts. Call once from initialize().
+ */
+void eventsInit();
+/**
+ * Subscribes to the edges on a pin. Call before eventsInit().
+ *
+ * @param pin the digital port, EVENTS_BALL_PIN
+ * @param handler the function to call for each edge
+ * @return false if EVENTS_MAX_HANDLERS are already subscribed
+ */
+bool eventsSubscribe(unsigned char pin, EventHandler handler);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+/** @file flywheel.h
+ * @brief Header file for the flywheel speed regulation task
+ *
+ * The flywheel is regulated by its own high priority task so that its timing does not depend
+ * on how much work the driver and autonomous loops do. Other code only publishes a target and
+ * reads back the measured speed and the ready flag.
+ */
+
+#ifndef FLYWHEEL_H_
+
+#define FLYWHEEL_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Flywheel regulation period in milliseconds.
+ */
+#define FLYWHEEL_PERIOD 10
+/**
+ * Window the flywheel speed is measured over in milliseconds. All speeds are in encoder counts
+ * per window, which matches the old 20 ms encoderSpeed() loops.
+ */
+#define FLYWHEEL_WINDOW 20
+/**
+ * Encoder counts kept to measure the speed over FLYWHEEL_WINDOW, one per FLYWHEEL_PERIOD. The
+ * history is a RingBuffer (see control.h), so this must be a power of two.
+ */
+#define FLYWHEEL_HISTORY (FLYWHEEL_WINDOW / FLYWHEEL_PERIOD)
+/**
+ * Speed drop below target, after being ready, that counts as a ball going through.
+ */
+#define FLYWHEEL_SHOT_DIP 5
+/**
+ * Priority of the flywheel regulation task.
+ */
+#define FLYWHEEL_PRIORITY (TASK_PRIORITY_DEFAULT + 2)
+
+/**
+ * A flywheel setpoint.
+ *
+ * Below speed - 5 the flywheel always runs at full power; within 5 counts under the target it
+ * runs at nearPower, and above the target it drops to overPower.
+ */
+typedef struct {
+  int speed;     // Target speed in encoder counts per FLYWHEEL_WINDOW ms
+  int tolerance; // The flywheel is ready while |speed - target| < tolerance
+  int nearPower; // Motor power just under the target speed
+  int overPower; // Motor power above the target speed
+} FlywheelTarget;
+
+/**
+ * CPU cycles the last regulation period spent in each step, all zero off the ARM toolchain.
+ * The steps run from RAM unless built with RAMFUNC_FLASH (see ramfunc.h).
+ */
+typedef struct {
+  unsigned int sample; // Reading the encoder and updating the speed
+  unsigned int step;   // Picking the motor power
+  unsigned int flush;  // Derating the power and sending it to the four flywheel motors
+} FlywheelCycles;
+
+// Stock setpoints; the driver presets are tunable from the console (see param.h)
+extern const FlywheelTarget flywheelOff;
+extern FlywheelTarget flywheelLongRange;
+extern FlywheelTarget flywheelMidRange;
+extern FlywheelTarget flywheelShortRange;
+
+/**
+ * Starts the flywheel regulation task. Call once from initialize() after speedEnc is set up.
+ */
+void flywheelInit();
+/**
+ * Publishes a new flywheel setpoint. The target is copied, so it may live on the stack.
+ *
+ * @param target the new setpoint
+ */
+void flywheelSetTarget(const FlywheelTarget *target);
+/**
+ * @return the target speed currently being regulated to
+ */
+int flywheelGetTarget();
+/**
+ * @return the last measured flywheel speed in encoder counts per FLYWHEEL_WINDOW ms
+ */
+int flywheelGetSpeed();
+/**
+ * @return true if the flywheel is spinning within the tolerance of the current setpoint
+ */
+bool flywheelReady();
+/**
+ * Checks the flywheel against a custom window around the current target speed.
+ *
+ * @param tolerance the window half-width, exclusive
+ * @return true if the flywheel is spinning within the window
+ */
+bool flywheelWithin(int tolerance);
+/**
+ * Counts shots as speed dips of FLYWHEEL_SHOT_DIP or more after the flywheel was ready.
+ *
+ * @return the number of shots since startup; compare differences, not absolute values
+ */
+int flywheelShots();
+/**
+ * Reads how long the last regulation period took in each step.
+ *
+ * @param cycles where to store the cycle counts
+ */
+void flywheelGetCycles(FlywheelCycles *cycles);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
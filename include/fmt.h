@@ -0,0 +1,89 @@
+/** @file fmt.h
+ * @brief Header file for the lightweight number formatter
+ *
+ * lcdPrint(), printf() and fprintf() interpret a format string on every call, with the PROS
+ * library's formatter. These routines cover what the robot actually prints (integers, fixed
+ * point, padded columns and hex) without one. host/fmtbench compares the two on the host only;
+ * what they save in image size and Cortex-M3 time has not been measured.
+ *
+ * Every routine writes into a caller supplied buffer, NUL terminates it and returns the number
+ * of characters written, not counting the NUL, so calls can be chained with "p += fmt...(p)".
+ * This file does not depend on API.h so it also builds for the host tools.
+ */
+
+#ifndef FMT_H_
+
+#define FMT_H_
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Buffer size that fits any formatted 32 bit number, including sign and NUL.
+ */
+#define FMT_INT_SIZE 12
+
+/**
+ * Writes a signed decimal integer.
+ *
+ * @param out the buffer, at least FMT_INT_SIZE bytes
+ * @param value the number to write
+ * @return the number of characters written
+ */
+int fmtInt(char *out, int value);
+/**
+ * Writes an unsigned decimal integer.
+ *
+ * @param out the buffer, at least FMT_INT_SIZE bytes
+ * @param value the number to write
+ * @return the number of characters written
+ */
+int fmtUnsigned(char *out, unsigned int value);
+/**
+ * Writes a signed decimal integer right aligned in a column, like "%5d" or "%05d".
+ * Numbers wider than the column are written in full.
+ *
+ * @param out the buffer, at least FMT_INT_SIZE or width + 1 bytes, whichever is larger
+ * @param value the number to write
+ * @param width the column width
+ * @param pad the padding character, ' ' or '0'
+ * @return the number of characters written
+ */
+int fmtPadded(char *out, int value, int width, char pad);
+/**
+ * Writes a fixed point number stored as an integer scaled by 10^decimals, so
+ * fmtFixed(out, 7412, 3) writes "7.412" and fmtFixed(out, -5, 2) writes "-0.05".
+ *
+ * @param out the buffer, at least FMT_INT_SIZE + 2 bytes
+ * @param value the scaled number to write
+ * @param decimals the number of digits after the point, from 0 to 9
+ * @return the number of characters written
+ */
+int fmtFixed(char *out, int value, int decimals);
+/**
+ * Writes an unsigned number as upper case hex with a fixed number of digits, like "%04X".
+ *
+ * @param out the buffer, at least digits + 1 bytes
+ * @param value the number to write
+ * @param digits the number of hex digits, from 1 to 8; higher digits are dropped
+ * @return the number of characters written
+ */
+int fmtHex(char *out, unsigned int value, int digits);
+/**
+ * Copies a string, stopping after limit characters.
+ *
+ * @param out the buffer, at least limit + 1 bytes
+ * @param text the string to copy
+ * @param limit the maximum number of characters to copy
+ * @return the number of characters written
+ */
+int fmtText(char *out, const char *text, int limit);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
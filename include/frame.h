@@ -0,0 +1,61 @@
+/** @file frame.h
+ * @brief Header file for COBS framing with a CRC
+ *
+ * A frame is the payload followed by its CRC-16/CCITT (little endian), COBS encoded so the
+ * only zero byte on the wire is the delimiter that ends each frame. A receiver that joins
+ * mid-stream or loses bytes resynchronises at the next zero.
+ *
+ * This file does not depend on API.h so it also builds for the host tools.
+ */
+
+#ifndef FRAME_H_
+
+#define FRAME_H_
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Largest payload that fits in one frame.
+ */
+#define FRAME_MAX_PAYLOAD 250
+/**
+ * Encoded size of a payload of the given length, including CRC, COBS overhead and delimiter.
+ */
+#define FRAME_SIZE(length) ((length) + 4)
+
+/**
+ * Computes the CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of a block.
+ *
+ * @param data the bytes to check
+ * @param length the number of bytes
+ * @return the CRC
+ */
+unsigned short frameCrc(const void *data, unsigned int length);
+/**
+ * Encodes a payload into a delimited frame.
+ *
+ * @param payload the bytes to send
+ * @param length the payload length, at most FRAME_MAX_PAYLOAD
+ * @param out the buffer, at least FRAME_SIZE(length) bytes
+ * @return the number of bytes written including the delimiter, or 0 if the payload is too long
+ */
+unsigned int frameEncode(const void *payload, unsigned int length, unsigned char *out);
+/**
+ * Decodes one frame and checks its CRC.
+ *
+ * @param frame the encoded bytes, without the delimiter
+ * @param length the number of encoded bytes
+ * @param out the buffer for the payload, at least length bytes
+ * @return the payload length, or -1 if the frame is malformed or fails its CRC
+ */
+int frameDecode(const unsigned char *frame, unsigned int length, unsigned char *out);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
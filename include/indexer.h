@@ -0,0 +1,88 @@
+/** @file indexer.h
+ * @brief Header file for the ball indexer state machine
+ *
+ * The intake (which also drives the conveyor) and ball control are sequenced together by one
+ * task instead of separate buttons. Driver control and autonomous only say what they want,
+ * load, fire or eject, and the indexer decides which motors run from the ball trackers (see
+ * ball.h) and the flywheel ready flag:
+ *
+ *   EMPTY       no balls in the conveyor; the intake runs only to load
+ *   LOADING     balls in the conveyor but none staged; the conveyor climbs them to the top
+ *   STAGED      a ball waits at the top under ball control
+ *   FIRING      ball control pushes the staged ball into the ready flywheel
+ *   RECOVERING  the ball has gone; the conveyor brings up the next one while the flywheel dip
+ *               registers, so the next ball is never fed on a stale ready flag
+ *
+ * Ball control only runs in FIRING, which is only entered, and only held, while the flywheel is
+ * ready. INDEXER_FORCE is the one exception, kept as a manual override for a failed sensor.
+ */
+
+#ifndef INDEXER_H_
+
+#define INDEXER_H_
+
+#include <API.h>
+#include "flywheel.h"
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * State machine period in milliseconds, matching the ball sampler.
+ */
+#define INDEXER_PERIOD 5
+/**
+ * Priority of the indexer task, level with the ball sampler and flywheel tasks.
+ */
+#define INDEXER_PRIORITY (TASK_PRIORITY_DEFAULT + 2)
+/**
+ * Milliseconds ball control may push without the ball leaving before the shot is abandoned
+ * for a recovery and a fresh attempt.
+ */
+#define INDEXER_FIRE_TIMEOUT 400
+/**
+ * Milliseconds after a ball leaves the top before the next can fire: one flywheel speed window
+ * and one regulation period, long enough for the shot's dip to clear the ready flag.
+ */
+#define INDEXER_RECOVER_TIME (FLYWHEEL_WINDOW + FLYWHEEL_PERIOD)
+
+// Request bits for indexerRequest()
+#define INDEXER_LOAD 0x01  // Take balls in from the floor
+#define INDEXER_FIRE 0x02  // Shoot whenever the flywheel is ready
+#define INDEXER_EJECT 0x04 // Run the intake backwards, overriding everything but INDEXER_FORCE
+#define INDEXER_FORCE 0x08 // Run everything forwards regardless of sensors and readiness
+
+/**
+ * Indexer states.
+ */
+typedef enum {
+  INDEXER_EMPTY = 0,
+  INDEXER_LOADING,
+  INDEXER_STAGED,
+  INDEXER_FIRING,
+  INDEXER_RECOVERING
+} IndexerState;
+
+/**
+ * Starts the indexer task. Call once from initialize() after ballInit() and jamInit().
+ */
+void indexerInit();
+/**
+ * Replaces the current request. Requests are levels, not events: call this every tick with
+ * what is wanted now, and 0 to stop. Requests are dropped while the robot is disabled.
+ *
+ * @param requests a combination of the INDEXER_ request bits
+ */
+void indexerRequest(int requests);
+/**
+ * @return the current state
+ */
+IndexerState indexerState();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,108 @@
+/** @file jam.h
+ * @brief Header file for intake jam detection and recovery
+ *
+ * Everything that drives the intake goes through jamIntake(). A monitor task watches for a
+ * jam and, when it sees one, takes the intake over for a short reverse then forward cycle to
+ * knock the ball loose before handing it back to whatever was last commanded.
+ *
+ * With an IME on the intake motor a jam is a stall: commanded forward but barely turning. Without
+ * one the monitor falls back to ball progress: the intake runs forward with balls in the
+ * conveyor and none staged, yet no ball reaches either line tracker (see ball.h).
+ */
+
+#ifndef JAM_H_
+
+#define JAM_H_
+
+#include <API.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * IME address of the intake motor, if it has one. Found by imeInitializeAll() in jamInit().
+ */
+#define JAM_IME_ADDRESS 0
+/**
+ * Monitor period in milliseconds.
+ */
+#define JAM_PERIOD 20
+/**
+ * Priority of the monitor task, above the driver loop so an unjam cycle keeps its timing.
+ */
+#define JAM_PRIORITY (TASK_PRIORITY_DEFAULT + 1)
+/**
+ * Lowest forward power that is expected to move the intake.
+ */
+#define JAM_MIN_POWER 64
+/**
+ * Intake output speed in RPM below which a powered intake counts as stalled.
+ */
+#define JAM_STALL_RPM 10
+/**
+ * Milliseconds of stall before it is a jam, long enough to ride through a ball being pulled in.
+ */
+#define JAM_STALL_TIME 300
+/**
+ * Milliseconds of the fallback's expected progress without a ball reaching a tracker before it
+ * is a jam.
+ */
+#define JAM_PROGRESS_TIME 1500
+/**
+ * Milliseconds the unjam cycle runs the intake backwards, then forwards at full power.
+ */
+#define JAM_REVERSE_TIME 250
+#define JAM_FORWARD_TIME 250
+/**
+ * Milliseconds after an unjam cycle before another jam can be detected.
+ */
+#define JAM_COOLDOWN 1000
+/**
+ * Unjam cycles in a row without progress after which the fallback decides the conveyor is
+ * empty and the ball count was stale (an outtake is never counted, for example) and zeroes it.
+ */
+#define JAM_RETRIES 2
+
+/**
+ * Jam detection and recovery counts since startup.
+ */
+typedef struct {
+  unsigned int jams;    // Jams detected, one unjam cycle each
+  unsigned int stalls;  // Of those, the ones the IME saw
+  unsigned int stale;   // Times the fallback zeroed a stale ball count
+} JamCounters;
+
+/**
+ * Looks for the intake IME and starts the monitor task. Call once from initialize(), after
+ * ballInit().
+ */
+void jamInit();
+/**
+ * Sets the intake power. The monitor task sends it to the motor within JAM_PERIOD, or when
+ * the unjam cycle ends if one is running.
+ *
+ * @param power the intake power, -127 to 127, positive inwards
+ */
+void jamIntake(int power);
+/**
+ * @return true while an unjam cycle has the intake
+ */
+bool jamActive();
+/**
+ * @return true if jams are detected from the IME, false for the ball progress fallback
+ */
+bool jamHasIme();
+/**
+ * Copies out the counters.
+ *
+ * @param counters where to copy them
+ */
+void jamGetCounters(JamCounters *counters);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -44,6 +44,31 @@
 #define MAIN_H_
 
 #include <API.h>
+#include "adc.h"
+#include "arena.h"
+#include "ball.h"
+#include "blackbox.h"
+#include "calib.h"
+#include "console.h"
+#include "control.h"
+#include "delta.h"
+#include "display.h"
+#include "driver.h"
+#include "events.h"
+#include "flywheel.h"
+#include "fmt.h"
+#include "frame.h"
+#include "indexer.h"
+#include "jam.h"
+#include "param.h"
+#include "power.h"
+#include "ramfunc.h"
+#include "range.h"
+#include "replay.h"
+#include "ring.h"
+#include "script.h"
+#include "telemetry.h"
+#include "thermal.h"
 // Allow usage of this file in C++ programs
 #ifdef __cplusplus
 extern "C" {
@@ -53,6 +78,30 @@ extern Encoder right;
 extern Encoder left;
 extern Encoder speedEnc;
 
+//Motor port numbers, for code that needs them at compile time like the control.h templates
+#define PORT_FRONT_LEFT_DRIVE 4
+#define PORT_FRONT_RIGHT_DRIVE 7
+#define PORT_BACK_LEFT_DRIVE 1
+#define PORT_BACK_RIGHT_DRIVE 6
+#define PORT_BALL_CONTROL 10
+#define PORT_FLYWHEEL_ONE 9
+#define PORT_FLYWHEEL_TWO 2
+#define PORT_FLYWHEEL_THREE 3
+#define PORT_FLYWHEEL_FOUR 8
+#define PORT_INTAKE 5
+
+//Motor ports, defined in auto.c
+extern const int frontLeftDrive;
+extern const int frontRightDrive;
+extern const int backLeftDrive;
+extern const int backRightDrive;
+extern const int ballControl;
+extern const int flywheelOne;
+extern const int flywheelTwo;
+extern const int flywheelThree;
+extern const int flywheelFour;
+extern const int intake;
+
 // A function prototype looks exactly like its declaration, but with a semicolon instead of
 // actual code. If a function does not match a prototype, compile errors will occur.
 
@@ -0,0 +1,100 @@
+/** @file param.h
+ * @brief Header file for the table of parameters tunable without a reflash
+ *
+ * Each tunable value stays the plain global the control code always read, so reading one costs
+ * exactly what it did before it was tunable and nothing on a control path goes through this
+ * module. A const table in param.c names each of those variables once, with its bounds and
+ * whether it is an integer or a fixed point number, and the console (see console.h) gets, sets
+ * and saves them by name.
+ *
+ * Saved values live in the flash file PARAM_FILE as one "name value" line per parameter, the
+ * same text a set command takes. A file from an older table loads whatever names it still
+ * shares with this one, and a value that no longer fits its bounds keeps the compiled default.
+ */
+
+#ifndef PARAM_H_
+
+#define PARAM_H_
+
+#include <API.h>
+#include "fmt.h"
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Name of the flash file the parameters are saved to.
+ */
+#define PARAM_FILE "params"
+/**
+ * Longest parameter name.
+ */
+#define PARAM_NAME 15
+/**
+ * Buffer size that fits any line paramFormat() writes, including the NUL.
+ */
+#define PARAM_FORMAT_SIZE (PARAM_NAME + 3 * (FMT_INT_SIZE + 2) + 8)
+/**
+ * Largest parameter file loaded, in bytes.
+ */
+#define PARAM_FILE_SIZE 1024
+
+/**
+ * Applies the saved parameters over the compiled defaults. Call once from initialize(),
+ * before the tasks that read them start.
+ *
+ * @return the number of parameters loaded
+ */
+int paramLoad();
+/**
+ * Saves every parameter to PARAM_FILE. Refused while the robot is enabled, since a flash write
+ * stalls every task.
+ *
+ * @return true if the file was written, false if the robot is enabled or the file could not
+ *         be opened
+ */
+bool paramSave();
+/**
+ * @return the number of parameters in the table
+ */
+int paramCount();
+/**
+ * Looks a parameter up by name.
+ *
+ * @param name the parameter name
+ * @return its index, or -1 if there is none by that name
+ */
+int paramFind(const char *name);
+/**
+ * Parses a "name value" line and sets the parameter if the value is within its bounds. Fixed
+ * point values take up to as many decimals as the parameter has, like "0.25".
+ *
+ * @param line the line, which is left unchanged
+ * @return the index of the parameter set, or -1 if the name is unknown, the value does not
+ *         parse or it is out of bounds
+ */
+int paramAssign(const char *line);
+/**
+ * Writes a parameter as the "name value" line paramAssign() takes, without a newline.
+ *
+ * @param out the buffer, at least PARAM_FORMAT_SIZE bytes
+ * @param index the parameter index
+ * @param bounds true to follow the value with its bounds, as "name value (min to max)"
+ * @return the number of characters written
+ */
+int paramFormat(char *out, int index, bool bounds);
+/**
+ * Counts successful sets and loads, so code that caches something computed from parameters
+ * can tell when to compute it again.
+ *
+ * @return the number of changes since startup; compare for equality only
+ */
+unsigned int paramChanges();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+/** @file power.h
+ * @brief Header file for brownout prediction and load shedding
+ *
+ * A sag below POWER_FLOOR on the main battery can reset the Cortex, which costs far more than
+ * any throttling. Every motor group writes its power through powerApply(), which records what
+ * was asked for and scales it by the group's current allowance. A task samples both batteries
+ * every POWER_PERIOD and fits the main battery to a straight line: the voltage at rest, less a
+ * sag per unit of commanded load. It predicts the voltage the commanded load will pull the
+ * battery down to, and if that is under the floor it cuts the allowance of the groups in
+ * POWER_LOAD_LIST order, lowest priority first, down to each group's minimum, until the
+ * prediction clears the floor. Allowances come back as a ramp once the danger has passed.
+ *
+ * Each cut is logged with the prediction and the measured voltage. A low priority task
+ * prints the log and the lowest voltages reached to stdout while the robot is disabled.
+ */
+
+#ifndef POWER_H_
+
+#define POWER_H_
+
+#include <API.h>
+#include "ramfunc.h"
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Every load as LOAD(id, name, motors, priority, minimum). Groups with the lowest priority are
+ * cut first and groups with the same priority are cut together. minimum is the smallest
+ * allowance in 128ths of full power a group is ever cut to. Reorder or retune here.
+ */
+#define POWER_LOAD_LIST(LOAD) \
+  LOAD(POWER_INTAKE, "intake", 1, 0, 0) \
+  LOAD(POWER_BALL_CONTROL, "ball", 1, 0, 0) \
+  LOAD(POWER_DRIVE_LEFT, "left", 2, 1, 48) \
+  LOAD(POWER_DRIVE_RIGHT, "right", 2, 1, 48) \
+  LOAD(POWER_FLYWHEEL, "flywheel", 4, 2, 80)
+
+#define POWER_LOAD_ID(id, name, motors, priority, minimum) id,
+/**
+ * Load identifiers.
+ */
+typedef enum {
+  POWER_LOAD_LIST(POWER_LOAD_ID)
+  POWER_LOADS
+} PowerLoad;
+#undef POWER_LOAD_ID
+
+/**
+ * Sample period in milliseconds.
+ */
+#define POWER_PERIOD 10
+/**
+ * Priority of the power task, level with the acquisition task and above the control tasks
+ * whose loads it scales.
+ */
+#define POWER_PRIORITY TASK_PRIORITY_HIGHEST
+/**
+ * Lowest predicted main battery voltage in millivolts allowed without a backup battery. The
+ * Cortex resets a little under 5.5 V.
+ */
+#define POWER_FLOOR 6000
+/**
+ * The same with a charged backup battery, which keeps the Cortex alive through a deeper dip.
+ */
+#define POWER_FLOOR_BACKUP 5600
+/**
+ * Backup battery voltage in millivolts above which it counts as charged.
+ */
+#define POWER_BACKUP_MIN 7000
+/**
+ * Starting sag in millivolts per motor at full power, until the task has fitted its own.
+ * Roughly a 393 at stall through a worn battery and the wiring.
+ */
+#define POWER_DEFAULT_SAG 400
+/**
+ * Period in milliseconds of the task that prints the log.
+ */
+#define POWER_REPORT_PERIOD 100
+/**
+ * Priority of the task that prints the log, below everything that moves the robot.
+ */
+#define POWER_REPORT_PRIORITY (TASK_PRIORITY_DEFAULT - 1)
+/**
+ * Allowance in 128ths given back each period once the danger has passed.
+ */
+#define POWER_RESTORE 4
+/**
+ * Bytes of queued log entries. Taken from the arena.
+ */
+#define POWER_LOG_SIZE 512
+
+/**
+ * Starts the power task and the task that prints its log. Call once from initialize().
+ */
+void powerInit();
+/**
+ * Records the power a group was asked for and scales it by the group's allowance. Every motor
+ * in the group gets the same power. Runs from RAM, as it sits on the flywheel's output path.
+ *
+ * @param load the group
+ * @param power the power asked for, -127 to 127
+ * @return the power to send to the motors
+ */
+RAMFUNC int powerApply(PowerLoad load, int power);
+/**
+ * @param load the group
+ * @return the group's allowance in 128ths of full power
+ */
+int powerAllowance(PowerLoad load);
+/**
+ * @return the lowest main battery voltage in millivolts seen while enabled since startup
+ */
+unsigned int powerMinimum();
+/**
+ * @return the number of cuts made since startup
+ */
+unsigned int powerInterventions();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+/** @file ramfunc.h
+ * @brief Header file for running hot functions from RAM and timing them in CPU cycles
+ *
+ * Flash on the Cortex's STM32F103 needs two wait states at 72 MHz, so a function marked
+ * RAMFUNC is linked into the .ramfunc section of firmware/cortex.ld instead. That section sits
+ * at the start of the initialized data, so the PROS startup copies it into RAM along with
+ * .data and it costs RAM for the whole match; keep it to the control loop's inner steps. The
+ * build prints the section size after linking.
+ *
+ * Define RAMFUNC_FLASH (add -DRAMFUNC_FLASH to CCFLAGS in common.mk) to leave everything in
+ * flash, and compare the cycle counts both builds report to see what each relocation buys:
+ * host/teledecode prints the flywheel's sample, step and flush cycles from the telemetry
+ * stream. This needs the robot itself; QEMU models no flash wait states. The linker script
+ * asserts its own load layout, and "make -C host test" links it with the host linker.
+ *
+ * Off the ARM toolchain (host tools and the simulator) RAMFUNC does nothing and the cycle
+ * counter reads zero.
+ */
+
+#ifndef RAMFUNC_H_
+
+#define RAMFUNC_H_
+
+#include <stdint.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__arm__) && !defined(RAMFUNC_FLASH)
+/**
+ * Places a function in RAM. RAM is out of direct branch range of flash, so callers use a long
+ * call, and the function is never inlined back into a flash caller.
+ */
+#define RAMFUNC __attribute__((section(".ramfunc"), long_call, noinline))
+#else
+#define RAMFUNC
+#endif
+
+#ifdef __arm__
+// Cortex-M3 debug registers for the DWT cycle counter
+#define RAMFUNC_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define RAMFUNC_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define RAMFUNC_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+#endif
+
+/**
+ * Starts the CPU cycle counter. Safe to call more than once.
+ */
+static inline void ramfuncCyclesInit() {
+#ifdef __arm__
+  RAMFUNC_DEMCR |= 1 << 24; //TRCENA, powers the DWT
+  RAMFUNC_DWT_CTRL |= 1;    //CYCCNTENA
+#endif
+}
+
+/**
+ * Reads the CPU cycle counter. It wraps about once a minute at 72 MHz, so only subtract
+ * readings taken close together.
+ *
+ * @return the free running cycle count, or 0 off the ARM toolchain
+ */
+static inline uint32_t ramfuncCycles() {
+#ifdef __arm__
+  return RAMFUNC_DWT_CYCCNT;
+#else
+  return 0;
+#endif
+}
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+/** @file range.h
+ * @brief Header file for the ultrasonic rangefinder and range to flywheel speed table
+ *
+ * An ultrasonic sensor faces the goal. A sampler task reads it, drops missed echoes and
+ * readings past the sensor's reach, takes the median of the last three to kill the odd bad echo
+ * and smooths the rest. rangeTarget() turns the filtered distance into a flywheel setpoint by
+ * interpolating between the driver presets, each placed in a const table at the distance it
+ * was tuned for, so retuning a preset retunes the ranges around it.
+ *
+ * The Cortex has no spare interrupt-capable digital port, so the echo line takes port 12, which
+ * held the intake entry switch before the analog entry tracker (see ball.h) replaced it.
+ */
+
+#ifndef RANGE_H_
+
+#define RANGE_H_
+
+#include <API.h>
+#include "flywheel.h"
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Digital port of the ultrasonic echo (orange) line.
+ */
+#define RANGE_ECHO_PORT 12
+/**
+ * Digital port of the ultrasonic ping (yellow) line.
+ */
+#define RANGE_PING_PORT 10
+/**
+ * Sample period in milliseconds, about the ping rate of the sensor.
+ */
+#define RANGE_PERIOD 50
+/**
+ * Milliseconds without a good reading before the distance is no longer trusted.
+ */
+#define RANGE_STALE 300
+/**
+ * Distance in centimetres the filtered range must move from the one the current setpoint was
+ * computed at before rangeTarget() computes a new one. Every new target speed clears the
+ * flywheel's ready flag, so a target that chased sensor noise would never let a ball through.
+ */
+#define RANGE_DEADBAND 5
+
+/**
+ * Share of the way the filtered distance moves to each new median, in thousandths. Tunable
+ * from the console (see param.h).
+ */
+extern int rangeSmoothing;
+
+/**
+ * Starts the ultrasonic and the sampler task. Call once from initialize().
+ */
+void rangeInit();
+/**
+ * Reads the filtered distance to the goal.
+ *
+ * @param cm where to store the distance in centimetres
+ * @return false, leaving cm unchanged, if there has been no good reading for RANGE_STALE ms
+ */
+bool rangeGet(int *cm);
+/**
+ * Looks up the flywheel setpoint for the current distance, interpolated between the rows of
+ * the range table and clamped to its ends. The setpoint only moves once the distance has moved
+ * RANGE_DEADBAND from where it was last computed. Call from one task only.
+ *
+ * @param target where to store the setpoint
+ * @return false, leaving target unchanged, if the distance is not trusted
+ */
+bool rangeTarget(FlywheelTarget *target);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
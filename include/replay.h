@@ -0,0 +1,80 @@
+/** @file replay.h
+ * @brief Header file for driver input record and replay
+ *
+ * A recording is the DriverInput of every driver loop tick plus a drive encoder checkpoint
+ * every REPLAY_CHECKPOINT ticks. Ticks that repeat the previous one are run length encoded and
+ * the rest are delta encoded with delta.h, so a 15 second take fits in a few kilobytes of RAM.
+ * The take is written to flash once the robot is disabled and can be fed back through
+ * driverStep() in autonomous(), steering towards the recorded encoder checkpoints.
+ */
+
+#ifndef REPLAY_H_
+
+#define REPLAY_H_
+
+#include "driver.h"
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Length of one take in milliseconds, an autonomous period.
+ */
+#define REPLAY_LENGTH 15000
+/**
+ * Ticks between drive encoder checkpoints.
+ */
+#define REPLAY_CHECKPOINT 10
+/**
+ * RAM reserved for one take in bytes, taken from the arena. A take that outgrows it ends early.
+ */
+#define REPLAY_BUFFER 4096
+/**
+ * Flash file holding the last take.
+ */
+#define REPLAY_FILE "replay"
+/**
+ * File magic, also the layout version.
+ */
+#define REPLAY_MAGIC "RPL1"
+
+/**
+ * Starts the task that saves finished takes while the robot is disabled. Call once from
+ * initialize().
+ */
+void replayInit();
+/**
+ * Starts a new take, dropping any unsaved one. Resets the drive encoders.
+ */
+void replayRecordStart();
+/**
+ * @return true while a take is being recorded
+ */
+bool replayRecording();
+/**
+ * Adds one driver loop tick to the current take. The take ends by itself after REPLAY_LENGTH.
+ *
+ * @param input the input driverStep() ran with this tick
+ */
+void replayRecord(const DriverInput *input);
+/**
+ * Loads the saved take for playback. Resets the drive encoders.
+ *
+ * @return true if a valid take was loaded
+ */
+bool replayLoad();
+/**
+ * Produces the next tick of the loaded take, with drift correction applied to the axes.
+ *
+ * @param input the snapshot to fill
+ * @return true if a tick was produced, false at the end of the take
+ */
+bool replayNext(DriverInput *input);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/** @file ring.h
+ * @brief Header file for the lock-free byte ring
+ *
+ * A single producer, single consumer ring of bytes. The producer and consumer may be
+ * different tasks (or an interrupt and a task) without any mutex, as long as there is only one
+ * of each. Writes are all or nothing, so a record is never split by a full ring.
+ *
+ * This file does not depend on API.h so it also builds for the host tools.
+ */
+
+#ifndef RING_H_
+
+#define RING_H_
+
+#include <stdbool.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Ring state. The counters run freely and wrap; only their difference matters.
+ */
+typedef struct {
+  unsigned char *buffer;
+  unsigned int size;          // Power of two
+  volatile unsigned int head; // Bytes ever written, only changed by the producer
+  volatile unsigned int tail; // Bytes ever read, only changed by the consumer
+} Ring;
+
+/**
+ * Sets up a ring over a caller supplied buffer.
+ *
+ * @param ring the ring to set up
+ * @param buffer the storage, which must outlive the ring
+ * @param size the storage size in bytes, which must be a power of two
+ */
+void ringInit(Ring *ring, unsigned char *buffer, unsigned int size);
+/**
+ * @param ring the ring to check
+ * @return the number of bytes waiting to be read
+ */
+unsigned int ringUsed(const Ring *ring);
+/**
+ * @param ring the ring to check
+ * @return the number of bytes that can be written
+ */
+unsigned int ringFree(const Ring *ring);
+/**
+ * Writes a block of bytes. Producer side only.
+ *
+ * @param ring the ring to write
+ * @param data the bytes to write
+ * @param length the number of bytes to write
+ * @return true if the block was written, false if it did not fit and nothing was written
+ */
+bool ringWrite(Ring *ring, const void *data, unsigned int length);
+/**
+ * Finds the longest run of readable bytes that is contiguous in memory. Consumer side only.
+ *
+ * @param ring the ring to read
+ * @param data set to the start of the run
+ * @return the length of the run, or 0 if the ring is empty
+ */
+unsigned int ringPeek(const Ring *ring, const unsigned char **data);
+/**
+ * Discards bytes from the read side, normally after handling a ringPeek() run. Consumer side
+ * only.
+ *
+ * @param ring the ring to read
+ * @param length the number of bytes to discard, at most ringUsed()
+ */
+void ringSkip(Ring *ring, unsigned int length);
+/**
+ * Copies bytes out of the ring. Consumer side only.
+ *
+ * @param ring the ring to read
+ * @param data the destination
+ * @param length the maximum number of bytes to read
+ * @return the number of bytes read
+ */
+unsigned int ringRead(Ring *ring, void *data, unsigned int length);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
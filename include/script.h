@@ -0,0 +1,127 @@
+/** @file script.h
+ * @brief Header file for the autonomous script engine
+ *
+ * Autonomous routines are tables of AutoStep opcodes rather than straight-line C. The engine
+ * never blocks: autoStep() is called once per AUTO_TICK, runs every instant opcode it reaches
+ * and returns as soon as an opcode has to wait. DRIVE and TURN only start a motion, which then
+ * runs in the background until a WAIT_DRIVE, so driving, intake and flywheel spin-up overlap.
+ *
+ * The engine never stops the flywheel itself: motions and AUTO_END only touch the drive,
+ * intake and ball control, and the flywheel task keeps regulating to the last AUTO_FLYWHEEL
+ * target through every drive phase.
+ *
+ * Routines are split into phases by AUTO_PHASE steps, each with an estimated duration and a
+ * value. The engine tracks the time left in the routine's budget and keeps enough of it for
+ * every later phase worth more than the current one: a phase that would eat into that time is
+ * dropped, and a running phase is cut short (its waits give up) once it does. A phase that
+ * has overrun its own estimate is also cut short once it starts eating into the time owed to
+ * any later phase.
+ */
+
+#ifndef SCRIPT_H_
+
+#define SCRIPT_H_
+
+#include <API.h>
+#include "flywheel.h"
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Script tick in milliseconds.
+ */
+#define AUTO_TICK 10
+
+/**
+ * Script opcodes. Instant opcodes run back to back in the same tick.
+ */
+typedef enum {
+  AUTO_END = 0,    // Stop drive, intake and ball control and end the script
+  AUTO_FLYWHEEL,   // Instant: set the flywheel to targets[arg]
+  AUTO_INTAKE,     // Instant: load balls if arg is positive, eject if negative, stop if 0
+  AUTO_DRIVE,      // Instant: start driving forward arg drive encoder counts
+  AUTO_TURN,       // Instant: start turning arg drive encoder counts, right if positive
+  AUTO_WAIT_DRIVE, // Wait for the current drive or turn to finish
+  AUTO_WAIT_READY, // Wait for the flywheel to be ready
+  AUTO_WAIT,       // Wait arg milliseconds
+  AUTO_SHOOT,      // Have the indexer fire until arg more shots, 0 is forever
+  AUTO_SIDE,       // Instant: jump to step arg if the side jumper is set
+  AUTO_JUMP,       // Instant: jump to step arg
+  AUTO_PHASE       // Instant: start phase phases[arg], or skip to the next phase if no time
+} AutoOp;
+
+/**
+ * One script step.
+ */
+typedef struct {
+  unsigned char op; // AutoOp
+  short arg;
+} AutoStep;
+
+/**
+ * Planning data for one phase of a routine.
+ */
+typedef struct {
+  unsigned short estimate; // Expected duration in milliseconds
+  unsigned char value;     // Higher values win time from lower ones
+} AutoPhase;
+
+/**
+ * An autonomous routine: its script and the tables the script indexes.
+ */
+typedef struct {
+  const AutoStep *program;       // The script, which must end in AUTO_END
+  const FlywheelTarget *targets; // Flywheel setpoints AUTO_FLYWHEEL steps index
+  const AutoPhase *phases;       // Phases AUTO_PHASE steps index
+  unsigned long budget;          // Time available for the whole routine in milliseconds
+} AutoRoutine;
+
+/**
+ * Script engine state. Treat as opaque.
+ */
+typedef struct {
+  const AutoRoutine *routine;
+  const AutoStep *program;
+  int side;
+  int pc;
+  bool started;            // Whether the waiting step at pc has been set up
+  unsigned long waitUntil; // AUTO_WAIT deadline
+  int shotsUntil;          // AUTO_SHOOT goal in flywheelShots() counts
+  int motion;              // Drive encoder goal of the current motion, 0 if stopped
+  int turn;                // 0 driving, 1 turning right, -1 turning left
+  unsigned long start;     // millis() when the routine started
+  unsigned long phaseStart;
+  unsigned long phaseEstimate;
+  unsigned long reserve;   // Time owed to later phases worth more than this one
+  unsigned long reserveAll; // Time owed to all later phases
+} AutoEngine;
+
+/**
+ * Loads a routine and starts its clock. Resets the drive encoders and stops the drive.
+ *
+ * @param engine the engine to load
+ * @param routine the routine to run
+ * @param side the field side, 1 if AUTO_SIDE steps should branch
+ */
+void autoStart(AutoEngine *engine, const AutoRoutine *routine, int side);
+/**
+ * @param engine the engine to check
+ * @return the milliseconds left in the routine's budget, 0 once it is spent
+ */
+unsigned long autoRemaining(const AutoEngine *engine);
+/**
+ * Advances the script by one tick.
+ *
+ * @param engine the engine to advance
+ * @return true while the script is running, false once it reached AUTO_END
+ */
+bool autoStep(AutoEngine *engine);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+/** @file telemetry.h
+ * @brief Header file for the binary telemetry stream
+ *
+ * A sampler task snapshots the flywheel, motors, battery, joystick and loop time into a fixed
+ * layout TelemetryRecord. Records are COBS framed with a CRC (see frame.h), queued in a lock
+ * free ring and drained to uart2 by a low priority sender, so a slow UART never holds up a
+ * control task. host/teledecode turns the stream back into CSV.
+ *
+ * The record layout is shared with the host decoder, so this file does not depend on API.h.
+ */
+
+#ifndef TELEMETRY_H_
+
+#define TELEMETRY_H_
+
+#include <stdint.h>
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Record layout version, bumped whenever TelemetryRecord changes.
+ */
+#define TELEMETRY_VERSION 3
+/**
+ * Baud rate of the telemetry UART.
+ */
+#define TELEMETRY_BAUD 115200
+/**
+ * Fastest supported sample period in milliseconds (100 Hz).
+ */
+#define TELEMETRY_MIN_PERIOD 10
+/**
+ * Bytes of framed records queued for the UART, about 29 records. Taken from the arena.
+ */
+#define TELEMETRY_RING_SIZE 1024
+
+// TelemetryRecord flags
+#define TELEMETRY_ENABLED 0x01
+#define TELEMETRY_AUTONOMOUS 0x02
+#define TELEMETRY_READY 0x04
+#define TELEMETRY_UNJAMMING 0x08
+
+/**
+ * One telemetry sample, sent little endian exactly as laid out here.
+ */
+typedef struct __attribute__((packed)) {
+  uint8_t version;     // TELEMETRY_VERSION
+  uint8_t flags;       // TELEMETRY_ENABLED | TELEMETRY_AUTONOMOUS | TELEMETRY_READY |
+                       // TELEMETRY_UNJAMMING
+  uint16_t sequence;   // Increments once per sample, including dropped ones
+  uint32_t time;       // millis() when sampled
+  int16_t targetSpeed; // Flywheel target in encoder counts per FLYWHEEL_WINDOW ms
+  int16_t speed;       // Measured flywheel speed in the same units
+  int8_t flywheel;     // Motor commands, -127 to 127
+  int8_t leftDrive;
+  int8_t rightDrive;
+  int8_t intake;
+  int8_t ballControl;
+  int8_t joyX;         // Joystick 1 axes 1 and 2
+  int8_t joyY;
+  uint16_t battery;    // Main battery in millivolts
+  uint16_t loopTime;   // Last driver loop time in microseconds
+  uint16_t dropped;    // Records dropped on the robot because the ring was full
+  uint16_t sampleCycles; // CPU cycles of the last flywheel steps, see FlywheelCycles
+  uint16_t stepCycles;
+  uint16_t flushCycles;
+  uint16_t jams;       // Intake jams detected since startup, see JamCounters
+} TelemetryRecord;
+
+/**
+ * Opens uart2 and starts the sampler and sender tasks. Call once from initialize().
+ *
+ * @param period the sample period in milliseconds, at least TELEMETRY_MIN_PERIOD
+ */
+void telemetryInit(unsigned long period);
+/**
+ * Takes one sample of every signal. The sequence and dropped counts are left at zero for the
+ * caller to fill in.
+ *
+ * @param record the record to fill
+ */
+void telemetrySample(TelemetryRecord *record);
+/**
+ * Publishes how long the current control loop pass took.
+ *
+ * @param us the loop time in microseconds
+ */
+void telemetryLoopTime(unsigned long us);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
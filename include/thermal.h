@@ -0,0 +1,111 @@
+/** @file thermal.h
+ * @brief Header file for the motor PTC thermal model and current derating
+ *
+ * Every 393 has a PTC fuse that opens once it gets hot and stays open until it cools, which
+ * leaves a mechanism dead for tens of seconds. A task estimates each motor's current from its
+ * command, the battery voltage and how fast its shaft turns, and heats a model of its fuse with
+ * the square of that current. The model predicts the heat THERMAL_HORIZON ahead at the present
+ * draw; once that passes THERMAL_SOFT it caps the current of every motor on the shaft, tighter
+ * the closer the prediction gets to THERMAL_LIMIT, so the fuse settles just short of tripping
+ * instead of opening.
+ *
+ * Heat is given as a share of the rise from ambient to the trip temperature. The model starts
+ * at ambient on every boot, so it underestimates motors still warm from a previous run.
+ */
+
+#ifndef THERMAL_H_
+
+#define THERMAL_H_
+
+#include <API.h>
+#include "ramfunc.h"
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Model period in milliseconds.
+ */
+#define THERMAL_PERIOD 20
+/**
+ * Priority of the thermal task. A limit a period late makes no difference to a fuse that
+ * takes over a minute to heat.
+ */
+#define THERMAL_PRIORITY (TASK_PRIORITY_DEFAULT + 1)
+/**
+ * Current in milliamps the 393's fuse (HR30-090) carries indefinitely without tripping.
+ */
+#define THERMAL_HOLD 900
+/**
+ * Thermal time constant of the fuse in milliseconds.
+ */
+#define THERMAL_TAU 88000
+/**
+ * Ambient and trip temperatures of the fuse in degrees C.
+ */
+#define THERMAL_AMBIENT 20
+#define THERMAL_TRIP 100
+/**
+ * How far ahead in milliseconds the heat is predicted at the present draw.
+ */
+#define THERMAL_HORIZON 1000
+/**
+ * Predicted heat in percent of the trip rise at which a shaft starts to be limited.
+ */
+#define THERMAL_SOFT 60
+/**
+ * Predicted heat in percent of the trip rise at which a shaft is held to the current its fuse
+ * can carry indefinitely.
+ */
+#define THERMAL_LIMIT 90
+/**
+ * Headroom in percent below which the driver and autonomous loops show it on the LCD.
+ */
+#define THERMAL_WARN 50
+
+/**
+ * Motors that turn together and so draw the same current for the same command.
+ */
+typedef enum {
+  THERMAL_FLYWHEEL, // Flywheel motors, measured by speedEnc
+  THERMAL_LEFT,     // Left drive, measured by left
+  THERMAL_RIGHT,    // Right drive, measured by right
+  THERMAL_FREE,     // Lightly loaded motors without an encoder, taken as running free
+  THERMAL_SHAFTS
+} ThermalShaft;
+
+/**
+ * Starts the thermal task. Call once from initialize() after the encoders are set up.
+ */
+void thermalInit();
+/**
+ * Clamps a shaft's power to the current limit its hottest motor is under. A power of 0 is
+ * passed through, since coasting motors draw nothing. A power against a shaft spinning the
+ * other way can be limited to 0, but never to a power of the opposite sign. Runs from RAM, as
+ * it sits on the flywheel's output path.
+ *
+ * @param shaft the shaft the power is for
+ * @param power the power asked for, -127 to 127
+ * @return the power to send to the motors
+ */
+RAMFUNC int thermalApply(ThermalShaft shaft, int power);
+/**
+ * @param shaft the shaft
+ * @return the heat its hottest motor can still take before tripping, in percent of the trip
+ *         rise: 100 at ambient, 0 at trip
+ */
+int thermalHeadroom(ThermalShaft shaft);
+/**
+ * @param port the motor port, 1 to 10
+ * @return the modelled temperature of the motor's fuse in degrees C, or THERMAL_AMBIENT for an
+ *         unmodelled port
+ */
+int thermalTemperature(unsigned char port);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,81 @@
+/** @file adc.c
+ * @brief File for the oversampled analog acquisition task
+ *
+ * The table is guarded by a sequence count rather than a mutex: the task makes it odd while
+ * publishing and even again after, and adcSample() copies again if the count was odd or moved.
+ * The task outranks every reader, so a reader can be interrupted by a publication but never
+ * the other way round, and the task never waits.
+ */
+
+#include "main.h"
+
+static volatile AdcSample table[BOARD_NR_ADC_PINS];
+static volatile unsigned int sequence;
+
+static int adcRead(unsigned char channel) {
+  if(ADC_INTEGRATING & (1 << (channel - 1))) {
+    return analogReadCalibratedHR(channel);
+  }
+  return analogRead(channel);
+}
+
+static void adcTask(void *ignore) {
+  int sum[BOARD_NR_ADC_PINS] = {0};
+  unsigned long wake = millis();
+  unsigned int taken = 0;
+  unsigned char channel;
+
+  while(1) {
+    for(channel = 1; channel <= BOARD_NR_ADC_PINS; channel++) {
+      sum[channel - 1] += adcRead(channel);
+    }
+    if(++taken == ADC_OVERSAMPLE) {
+      sequence++;
+      __asm__ volatile("" ::: "memory"); //Mark the table busy before touching it
+      for(channel = 0; channel < BOARD_NR_ADC_PINS; channel++) {
+        table[channel].value = sum[channel] / ADC_OVERSAMPLE;
+        table[channel].time = wake;
+        sum[channel] = 0;
+      }
+      __asm__ volatile("" ::: "memory");
+      sequence++;
+      taken = 0;
+    }
+    taskDelayUntil(&wake, ADC_PERIOD);
+  }
+}
+
+void adcInit() {
+  unsigned char channel;
+
+  for(channel = 1; channel <= BOARD_NR_ADC_PINS; channel++) {
+    if(ADC_INTEGRATING & (1 << (channel - 1))) {
+      analogCalibrate(channel);
+    }
+    table[channel - 1].value = adcRead(channel);
+    table[channel - 1].time = millis();
+  }
+  taskCreate(adcTask, TASK_DEFAULT_STACK_SIZE, NULL, ADC_PRIORITY);
+}
+
+int adcGet(unsigned char channel) {
+  if(channel < 1 || channel > BOARD_NR_ADC_PINS) {
+    return 0;
+  }
+  return table[channel - 1].value;
+}
+
+bool adcSample(unsigned char channel, AdcSample *sample) {
+  unsigned int before;
+
+  if(channel < 1 || channel > BOARD_NR_ADC_PINS) {
+    return false;
+  }
+  do {
+    before = sequence;
+    __asm__ volatile("" ::: "memory");
+    *sample = table[channel - 1];
+    __asm__ volatile("" ::: "memory");
+  } while((before & 1) || before != sequence);
+  return true;
+}
@@ -0,0 +1,135 @@
+/** @file arena.c
+ * @brief File for the static arena allocator
+ *
+ * Pools sit back to back in one array in ARENA_POOL_LIST order. Each pool is a bump allocator;
+ * nothing is ever freed.
+ *
+ * The heap wrappers are the __wrap_ half of the linker's --wrap: every call to malloc() in the
+ * image lands here, and __real_malloc() is the library's own.
+ */
+
+#include "main.h"
+#include <string.h>
+
+#define ARENA_ROUND(size) (((size) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+#define ARENA_POOL_SIZE(id, name, size) ARENA_ROUND(size) +
+#define ARENA_POOL_INFO(id, name, size) {name, ARENA_ROUND(size)},
+
+//Whole arena size, the sum of the rounded pool sizes
+#define ARENA_TOTAL (ARENA_POOL_LIST(ARENA_POOL_SIZE) 0)
+
+//Only the robot's linker script has an .arena output section
+#ifdef __arm__
+#define ARENA_SECTION __attribute__((section(".arena"), aligned(ARENA_ALIGN)))
+#else
+#define ARENA_SECTION __attribute__((aligned(ARENA_ALIGN)))
+#endif
+
+typedef struct {
+  const char *name;
+  unsigned int size;
+} ArenaPoolInfo;
+
+static const ArenaPoolInfo pools[ARENA_POOLS] = {
+  ARENA_POOL_LIST(ARENA_POOL_INFO)
+};
+
+static unsigned char arena[ARENA_TOTAL] ARENA_SECTION;
+static unsigned int used[ARENA_POOLS];
+static volatile unsigned int violations;
+static volatile unsigned int heapCalls;
+static volatile bool frozen;
+
+#ifdef __arm__
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *block, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  if(frozen) {
+    heapCalls++;
+  }
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  if(frozen) {
+    heapCalls++;
+  }
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *block, size_t size) {
+  if(frozen) {
+    heapCalls++;
+  }
+  return __real_realloc(block, size);
+}
+#endif
+
+void *arenaAlloc(ArenaPool pool, unsigned int size) {
+  unsigned int offset = 0;
+  unsigned char *block;
+  int i;
+
+  size = ARENA_ROUND(size);
+  if(frozen || pool >= ARENA_POOLS || size > pools[pool].size - used[pool]) {
+    violations++;
+    return NULL;
+  }
+  for(i = 0; i < (int)pool; i++) {
+    offset += pools[i].size;
+  }
+  block = arena + offset + used[pool];
+  used[pool] += size;
+  memset(block, 0, size); //The robot's startup never zeroes the arena
+  return block;
+}
+
+void arenaFreeze() {
+  frozen = true;
+  arenaReport(stdout);
+}
+
+bool arenaFrozen() {
+  return frozen;
+}
+
+unsigned int arenaViolations() {
+  return violations;
+}
+
+unsigned int arenaHeapCalls() {
+  return heapCalls;
+}
+
+unsigned int arenaUsed(ArenaPool pool) {
+  return pool < ARENA_POOLS ? used[pool] : 0;
+}
+
+unsigned int arenaSize(ArenaPool pool) {
+  return pool < ARENA_POOLS ? pools[pool].size : 0;
+}
+
+void arenaReport(FILE *out) {
+  char line[48];
+  int count;
+  int i;
+
+  for(i = 0; i < ARENA_POOLS; i++) {
+    count = fmtText(line, "arena ", 6);
+    count += fmtText(line + count, pools[i].name, 15);
+    line[count++] = ' ';
+    count += fmtUnsigned(line + count, used[i]);
+    line[count++] = '/';
+    fmtUnsigned(line + count, pools[i].size);
+    fputs(line, out);
+  }
+  count = fmtText(line, "arena violations ", 17);
+  fmtUnsigned(line + count, violations);
+  fputs(line, out);
+  count = fmtText(line, "arena heap calls ", 17);
+  fmtUnsigned(line + count, heapCalls);
+  fputs(line, out);
+}
@@ -33,6 +33,7 @@
  */
 
 #include "main.h"
+#include <string.h>
 
 /*
  * Runs the user autonomous code. This function will be started in its own task with the default
@@ -51,156 +52,93 @@
 
 //Motor Constants
 
-const int frontLeftDrive = 4;
-const int frontRightDrive = 7;
-const int backLeftDrive = 1;
-const int backRightDrive = 6;
-const int ballControl = 10;
-const int flywheelTwo = 2;
-const int flywheelThree = 3;
-const int flywheelOne = 9;
-const int flywheelFour = 8;
-const int intake = 5;
-
-void stopAll() {
-  motorSet(frontLeftDrive, 0);
-  motorSet(backLeftDrive, 0);
-  motorSet(backRightDrive, 0);
-  motorSet(frontRightDrive, 0);
-  motorSet(intake, 0);
-  motorSet(flywheelOne, 0);
-  motorSet(flywheelTwo, 0);
-  motorSet(flywheelThree, 0);
-  motorSet(flywheelFour, 0);
-  motorSet(ballControl, 0);
-}
-
-int encoderSpeed(){				//Gets encoder speed.
-  int old;
-  int new;
-  
-  old = encoderGet(speedEnc); //Gets encoder before time delay
-  delay(20);
-  new = encoderGet(speedEnc); //Get encoder after time delay
-  return new - old;			//Get Rotations per delay ms
-}
-
-void conveyorForward() {        //Intakes
-  motorSet(intake, 127);
-}
-
-void conveyorStop() {			//Stop conveyor
-  motorSet(intake, 0);
-}
-
-void conveyorBackward() { 		//Outtake
-  motorSet(intake, -127);
-}
-
-void flywheelStart() {			//Start Flywheel
-  motorSet(flywheelOne, 127);
-  motorSet(flywheelTwo, 127);
-  motorSet(flywheelThree, 127);
-  motorSet(flywheelFour, 127);
-}
-
-void flywheelHalf() {			//Start Flywheel
-  motorSet(flywheelOne, 50);
-  motorSet(flywheelTwo, 50);
-  motorSet(flywheelThree, 50);
-  motorSet(flywheelFour, 50);
-}
-
-void flywheelStop() {			//Stop Flywheel
-  motorSet(flywheelOne, 0);
-  motorSet(flywheelTwo, 0);
-  motorSet(flywheelThree, 0);
-  motorSet(flywheelFour, 0);
-}
-
-void runBallControl() {  		//Allows a ball to shoot
-  motorSet(ballControl, 127);
-}
-
-void stopBallControl() {		//Stop balls from shooting
-  motorSet(ballControl, 0);
-}
-
-void forwardIntake(int dist){
-	while(encoderGet(left) < dist && encoderGet(right) < dist){
-		motorSet(frontLeftDrive, 127);
-		motorSet(backLeftDrive, 127);
-		motorSet(backRightDrive, 127);
-		motorSet(frontRightDrive, -127);
-		motorSet(intake, 127);
-		conveyorForward();
-	}
-    stopAll();
-    encoderReset(left);
-    encoderReset(right);
-}
-
-void forwardOuttake(int dist) {
-	while(encoderGet(left) < dist && encoderGet(right) < dist){
-		motorSet(frontLeftDrive, 127);
-		motorSet(backLeftDrive, 127);
-		motorSet(backRightDrive, 127);
-		motorSet(frontRightDrive, -127);
-		motorSet(intake, -127);
-		conveyorBackward();
-	}
-	stopAll();
-	encoderReset(left);
-	encoderReset(right);
-}
-
-void rightTurn(int dist)  {
-	while(encoderGet(left) < dist && encoderGet(right) > -dist){
-		motorSet(frontLeftDrive, 127);
-		motorSet(backLeftDrive, 127);
-		motorSet(backRightDrive, -127);
-		motorSet(frontRightDrive, 127);
-	}
-    stopAll();
-    encoderReset(left);
-    encoderReset(right);
-}
-
-void leftTurn(int dist) {
-	while(encoderGet(left) > -dist && encoderGet(right) < dist){
-		motorSet(frontLeftDrive, -127);
-		motorSet(backLeftDrive, -127);
-		motorSet(backRightDrive, 127);
-		motorSet(frontRightDrive, -127);
-	}
-    stopAll();
-    encoderReset(left);
-    encoderReset(right);
-}
+const int frontLeftDrive = PORT_FRONT_LEFT_DRIVE;
+const int frontRightDrive = PORT_FRONT_RIGHT_DRIVE;
+const int backLeftDrive = PORT_BACK_LEFT_DRIVE;
+const int backRightDrive = PORT_BACK_RIGHT_DRIVE;
+const int ballControl = PORT_BALL_CONTROL;
+const int flywheelTwo = PORT_FLYWHEEL_TWO;
+const int flywheelThree = PORT_FLYWHEEL_THREE;
+const int flywheelOne = PORT_FLYWHEEL_ONE;
+const int flywheelFour = PORT_FLYWHEEL_FOUR;
+const int intake = PORT_INTAKE;
+
+//Flywheel setpoints: speed, ready tolerance, power just under target, power over target
+static const FlywheelTarget autoTargets[] = {
+  {0, 0, 0, 0},      //TARGET_OFF
+  {83, 1, 127, 50},  //TARGET_MATCH_LONG
+  {77, 5, 75, 0},    //TARGET_MATCH_SHORT
+  {83, 2, 127, 50},  //TARGET_SKILLS
+};
+enum {TARGET_OFF, TARGET_MATCH_LONG, TARGET_MATCH_SHORT, TARGET_SKILLS};
+
+//Routine phases: estimated milliseconds, value. Higher value phases keep their time.
+static const AutoPhase autoPhases[] = {
+  {4000, 3},  //PHASE_PRELOADS
+  {3000, 1},  //PHASE_PICKUP
+  {2500, 2},  //PHASE_SECOND_VOLLEY
+  {0, 1},     //PHASE_SKILLS
+};
+enum {PHASE_PRELOADS, PHASE_PICKUP, PHASE_SECOND_VOLLEY, PHASE_SKILLS};
+
+//Autonomous period lengths in milliseconds
+#define MATCH_BUDGET 15000
+#define SKILLS_BUDGET 60000
+
+///////////////MATCH AUTONOMOUS////////////////
+static const AutoStep matchProgram[] = {
+  /*  0 */ {AUTO_PHASE, PHASE_PRELOADS},
+  /*  1 */ {AUTO_FLYWHEEL, TARGET_MATCH_LONG},
+  /*  2 */ {AUTO_SHOOT, 4},              //Shoot the preloads
+  /*  3 */ {AUTO_PHASE, PHASE_PICKUP},
+  /*  4 */ {AUTO_FLYWHEEL, TARGET_MATCH_SHORT}, //Keep spinning for the second volley
+  /*  5 */ {AUTO_SIDE, 14},
+  /*  6 */ {AUTO_TURN, 30},             //Side 0: right, pick up, left
+  /*  7 */ {AUTO_WAIT_DRIVE, 0},
+  /*  8 */ {AUTO_INTAKE, 127},
+  /*  9 */ {AUTO_DRIVE, 800},
+  /* 10 */ {AUTO_WAIT_DRIVE, 0},
+  /* 11 */ {AUTO_INTAKE, 0},
+  /* 12 */ {AUTO_TURN, -100},
+  /* 13 */ {AUTO_JUMP, 21},
+  /* 14 */ {AUTO_TURN, -40},            //Side 1: left, pick up, right
+  /* 15 */ {AUTO_WAIT_DRIVE, 0},
+  /* 16 */ {AUTO_INTAKE, 127},
+  /* 17 */ {AUTO_DRIVE, 800},
+  /* 18 */ {AUTO_WAIT_DRIVE, 0},
+  /* 19 */ {AUTO_INTAKE, 0},
+  /* 20 */ {AUTO_TURN, 100},
+  /* 21 */ {AUTO_WAIT_DRIVE, 0},
+  /* 22 */ {AUTO_PHASE, PHASE_SECOND_VOLLEY},
+  /* 23 */ {AUTO_FLYWHEEL, TARGET_MATCH_SHORT},
+  /* 24 */ {AUTO_SHOOT, 0},             //Shoot at short range for the rest of the period
+  /* 25 */ {AUTO_END, 0},
+};
+
+/////////////////////////SKILLS AUTONOMOUS/////////////////////////////////
+static const AutoStep skillsProgram[] = {
+  /*  0 */ {AUTO_PHASE, PHASE_SKILLS},
+  /*  1 */ {AUTO_FLYWHEEL, TARGET_SKILLS},
+  /*  2 */ {AUTO_SHOOT, 0},
+  /*  3 */ {AUTO_END, 0},
+};
+
+static const AutoRoutine matchRoutine = {matchProgram, autoTargets, autoPhases, MATCH_BUDGET};
+static const AutoRoutine skillsRoutine = {skillsProgram, autoTargets, autoPhases, SKILLS_BUDGET};
 
 Encoder left;
 Encoder right;
 Encoder speedEnc;
 void autonomous() {
-  int speed;
-  int targetSpeed = 83;
+  AutoEngine engine;
+  DriverInput input;
+  unsigned long wake;
   int side = 0;
+  bool match;
+  int headroom;
 
-  if(!left){
-  left = encoderInit(3, 4, 1);
-  }
-  if(!right){
-  right = encoderInit(5, 6, 1);
-  }
-  if(!speedEnc){
-  speedEnc = encoderInit(1, 2, 0);
-  }
-
-  encoderReset(left);
-  encoderReset(right);
-  encoderReset(speedEnc);
+  ballSetCount(BALL_PRELOADS); //Loaded by hand, the entry tracker never saw them
   
-  lcdInit(uart1);
   lcdSetBacklight(uart1, true);
 
   if(digitalRead(8) == HIGH){
@@ -208,108 +146,34 @@ void autonomous() {
   } else {
 	  side = 0;
   }
-
-  ///////////////MATCH AUTONOMOUS////////////////
-  if(digitalRead(7) == HIGH){
-    while(1){
-      lcdPrint(uart1, 1, "SWEET AUTO");
-      lcdPrint(uart1, 2, "%d", encoderGet(speedEnc));
-      speed = encoderSpeed();
-      
-      if(speed < targetSpeed){ //Flywheel control statements. Turns them on if they aren't fast enough, turns it of if it's too fast.
-    	  flywheelStart();
-      }else if (speed > targetSpeed) {
-    	  flywheelHalf();
-      }else if (speed > targetSpeed + 4){ //If flywheel is too fast, slow down
-    	  flywheelStop();
-      }
-      
-      if((speed > targetSpeed - 1) && (speed < targetSpeed + 1)){ //Ball control loop. Make the added values larger to make it less accurate
-    	  runBallControl();
-      } else {
-    	  stopBallControl();
-      }
-      
-      if((speed > targetSpeed - 3) && (speed < targetSpeed + 3)){ //Conveyor control loop. Make the conveyor run a little more than the ballControl.
-    	  conveyorForward();
-      } else {
-    	  conveyorStop();
-      }
-      if(encoderGet(speedEnc) > 27000){
-    	  stopAll();
-    	  lcdPrint(uart1, 1, "Stopped");
-    	  break;
-      }
-    }
-
-    if(side == 0){
-    	rightTurn(30);
-    	forwardIntake(800);
-    	leftTurn(100);
-    } else if (side == 1){
-    	leftTurn(40);
-    	forwardIntake(800);
-    	rightTurn(100);
-    }
-
-    targetSpeed = 77;
-
-    conveyorForward();
-    while(1) {
-      lcdPrint(uart1, 1, "HOT DANG!");
-      lcdPrint(uart1, 2, "%d Flywheel", encoderGet(speedEnc));
-      speed = encoderSpeed();
-
-      //Shoot balls at short range
-      if((speed > targetSpeed - 5) && (speed < targetSpeed)) {
-        motorSet(flywheelOne, 75);
-        motorSet(flywheelTwo, 75);
-        motorSet(flywheelThree, 75);
-        motorSet(flywheelFour, 75);
-      } else if (speed > targetSpeed){
-        motorSet(flywheelOne, 0);
-        motorSet(flywheelTwo, 0);
-        motorSet(flywheelThree, 0);
-        motorSet(flywheelFour, 0);
-      } else if(speed < targetSpeed){ //If flywheel isn't fast enough, speed up
-        motorSet(flywheelOne, 127);
-        motorSet(flywheelTwo, 127);
-        motorSet(flywheelThree, 127);
-        motorSet(flywheelFour, 127);
-      }
-
-      if ((speed > targetSpeed - 5) && (speed < targetSpeed + 5)){
-    	  motorSet(ballControl, 127);
-      } else {
-    	  motorSet(ballControl, 0);
-      }
+  match = digitalRead(7) == HIGH;
+
+  ///////////////REPLAY AUTONOMOUS////////////////
+  if(digitalRead(9) == LOW && replayLoad()){ //Jumper in 9 plays back the last driver recording
+    displayText(1, "REPLAY AUTO");
+    wake = millis();
+    while(replayNext(&input)){
+      driverStep(&input);
+      displayValue(2, encoderGet(speedEnc), "Flywheel");
+      taskDelayUntil(&wake, DRIVER_PERIOD);
     }
+    memset(&input, 0, sizeof(input)); //Let go of the sticks and buttons
+    driverStep(&input);
+    displayText(1, "Stopped");
+    return;
+  }
 
-    /////////////////////////SKILLS AUTONOMOUS/////////////////////////////////
-  } else if (digitalRead(7) == LOW) {
-    while(1){
-      lcdPrint(uart1, 1, "SKILLS AUTO");
-      speed = encoderSpeed();
-      
-      if(speed < targetSpeed){ //Flywheel control statements. Turns them on if they aren't fast enough, turns it of if it's too fast.
-	flywheelStart();
-      }else if (speed > targetSpeed) {
-	flywheelHalf();
-      }else if (speed > targetSpeed + 4){ //If flywheel is too fast, slow down
-	flywheelStop();
-      }
-      
-      if((speed > targetSpeed - 1) && (speed < targetSpeed + 2)){ //Ball control loop. Make the added values larger to make it less accurate
-	runBallControl();
-      } else {
-	stopBallControl();
-      }
-      
-      if((speed > targetSpeed - 3) && (speed < targetSpeed + 3)){ //Conveyor control loop. Make the conveyor run a little more than the ballControl.
-	conveyorForward();
-      } else {
-	conveyorStop();
-      }
+  displayText(1, match ? "SWEET AUTO" : "SKILLS AUTO");
+  autoStart(&engine, match ? &matchRoutine : &skillsRoutine, side);
+  wake = millis();
+  while(autoStep(&engine)) {
+    headroom = thermalHeadroom(THERMAL_FLYWHEEL);
+    if(headroom < THERMAL_WARN) { //The flywheel is being held back to save its fuses
+      displayValue(2, headroom, "PTC headroom");
+    } else {
+      displayValue(2, encoderGet(speedEnc), "Flywheel");
     }
+    taskDelayUntil(&wake, AUTO_TICK);
   }
+  displayText(1, "Stopped");
 }
@@ -0,0 +1,114 @@
+/** @file ball.c
+ * @brief File for analog ball presence sensing
+ *
+ * Each tracker's empty reading is a calibrated baseline (see calib.h); a sample from the
+ * acquisition table (see adc.h) is judged by how far it drops below that. A ball leaving the
+ * top while ball control pushes forward, or did within BALL_FIRE_WINDOW, is a shot; leaving any
+ * other way (outtake) is not counted.
+ *
+ * The staged ball also holds down the switch on EVENTS_BALL_PIN, whose edges arrive through
+ * events.h. Either the top tracker or the switch marks a ball staged, so a failed tracker (or
+ * a broken switch wire) still leaves the conveyor working, and a shot is seen as soon as the
+ * first of the two lets go.
+ */
+
+#include "main.h"
+
+typedef struct {
+  unsigned char port;
+  int empty;             //Reading with no ball in front
+  volatile bool present;
+} BallTracker;
+
+static BallTracker top = {BALL_TOP_PORT, BALL_DEFAULT_EMPTY, false};
+static BallTracker entry = {BALL_ENTRY_PORT, BALL_DEFAULT_EMPTY, false};
+static volatile bool pressed; //The staged ball switch, as of its last edge
+static volatile bool present; //Staged by either sensor
+static volatile int count;
+static volatile unsigned long lastBall;
+
+//A stored empty reading is kept through any lower reading, which is just a preload in front; a
+//reading more than BALL_OFF_DROP higher means the stored baseline is stale and is measured again
+static void ballCalibrate(BallTracker *tracker) {
+  int empty = calibAnalog(tracker->port, BALL_DEFAULT_EMPTY, BALL_OFF_DROP) / 16;
+
+  tracker->empty = empty < BALL_EMPTY_MIN ? BALL_DEFAULT_EMPTY : empty;
+}
+
+//Called by the events dispatcher on each edge of the staged ball switch, which reads LOW pressed
+static void ballSwitch(const Event *event) {
+  pressed = event->level == LOW;
+}
+
+//Updates one tracker, returns 1 if a ball arrived, -1 if one left, 0 otherwise
+static int ballSample(BallTracker *tracker) {
+  int drop = tracker->empty - adcGet(tracker->port);
+
+  if(!tracker->present && drop >= BALL_ON_DROP) {
+    tracker->present = true;
+    return 1;
+  }
+  if(tracker->present && drop < BALL_OFF_DROP) {
+    tracker->present = false;
+    return -1;
+  }
+  return 0;
+}
+
+static void ballTask(void *ignore) {
+  unsigned long wake = millis();
+  unsigned long pushed = wake - BALL_FIRE_WINDOW;
+  bool staged = false;
+  bool was;
+  int next;
+
+  while(1) {
+    next = count;
+    if(motorGet(ballControl) > 0) {
+      pushed = millis();
+    }
+    if(ballSample(&entry) > 0) {
+      next++;
+      lastBall = millis();
+    }
+    ballSample(&top);
+    was = staged;
+    staged = top.present || pressed;
+    if(staged && !was) {
+      lastBall = millis();
+    } else if(!staged && was && millis() - pushed < BALL_FIRE_WINDOW && next > 0) { //Fired
+      next--;
+    }
+    if(staged && next < 1) { //A ball the entry tracker missed
+      next = 1;
+    }
+    present = staged;
+    count = next;
+    taskDelayUntil(&wake, BALL_PERIOD);
+  }
+}
+
+void ballInit() {
+  ballCalibrate(&top);
+  ballCalibrate(&entry);
+  pressed = digitalRead(EVENTS_BALL_PIN) == LOW;
+  eventsSubscribe(EVENTS_BALL_PIN, ballSwitch);
+  lastBall = millis();
+  taskCreate(ballTask, TASK_DEFAULT_STACK_SIZE, NULL, BALL_PRIORITY);
+}
+
+bool ballPresent() {
+  return present;
+}
+
+int ballCount() {
+  return count;
+}
+
+void ballSetCount(int next) {
+  count = next;
+}
+
+unsigned long ballIdleTime() {
+  return millis() - lastBall;
+}
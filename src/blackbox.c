@@ -0,0 +1,167 @@
+/** @file blackbox.c
+ * @brief File for the post-match black-box logger
+ *
+ * The recorder is both producer and consumer of its ring: it encodes while enabled and flushes
+ * while disabled, so recording never waits on flash and flash is never written mid-match.
+ * Holding the LCD center button while disabled dumps every file to stdout.
+ */
+
+#include "main.h"
+#include <string.h>
+
+static Ring ring;
+static Delta delta;
+static uint32_t session;         //Session of the next file
+static int slot;                 //Rotation slot of the next file
+static uint32_t samples;
+static uint32_t dropped;
+
+static void blackboxName(char *name, int file) {
+  name[0] = 'b';
+  name[1] = 'b';
+  fmtInt(name + 2, file);
+}
+
+static bool blackboxReadHeader(int file, BlackboxHeader *header) {
+  char name[4 + FMT_INT_SIZE];
+  FILE *in;
+  bool valid;
+
+  blackboxName(name, file);
+  in = fopen(name, "r");
+  if(!in) {
+    return false;
+  }
+  valid = fread(header, 1, sizeof(*header), in) == sizeof(*header) &&
+    memcmp(header->magic, BLACKBOX_MAGIC, sizeof(header->magic)) == 0;
+  fclose(in);
+  return valid;
+}
+
+static void blackboxSample() {
+  TelemetryRecord record;
+  int values[BLACKBOX_FIELDS];
+  unsigned char encoded[DELTA_MAX_SIZE];
+  Delta previous = delta;
+  int length;
+
+  telemetrySample(&record);
+  values[BLACKBOX_TIME] = (int)record.time;
+  values[BLACKBOX_SPEED] = record.speed;
+  values[BLACKBOX_FLYWHEEL] = record.flywheel;
+  values[BLACKBOX_BATTERY] = record.battery;
+  values[BLACKBOX_LEFT_DRIVE] = record.leftDrive;
+  values[BLACKBOX_RIGHT_DRIVE] = record.rightDrive;
+  values[BLACKBOX_JOY_X] = record.joyX;
+  values[BLACKBOX_JOY_Y] = record.joyY;
+  values[BLACKBOX_TARGET_SPEED] = record.targetSpeed;
+  values[BLACKBOX_INTAKE] = record.intake;
+  values[BLACKBOX_BALL_CONTROL] = record.ballControl;
+  values[BLACKBOX_FLAGS] = record.flags;
+  values[BLACKBOX_LOOP_TIME] = record.loopTime;
+
+  length = deltaEncode(&delta, values, encoded);
+  if(ringWrite(&ring, encoded, length)) {
+    samples++;
+  } else { //Keep the codec in step with what actually got stored
+    delta = previous;
+    dropped++;
+  }
+}
+
+static void blackboxFlush() {
+  BlackboxHeader header;
+  char name[4 + FMT_INT_SIZE];
+  const unsigned char *run;
+  unsigned int length;
+  FILE *out;
+
+  memcpy(header.magic, BLACKBOX_MAGIC, sizeof(header.magic));
+  header.session = session;
+  header.period = BLACKBOX_PERIOD;
+  header.fields = BLACKBOX_FIELDS;
+  header.samples = samples;
+  header.dropped = dropped;
+  header.length = ringUsed(&ring);
+
+  blackboxName(name, slot);
+  out = fopen(name, "w");
+  if(!out) {
+    return;
+  }
+  fwrite(&header, sizeof(header), 1, out);
+  while((length = ringPeek(&ring, &run)) > 0) {
+    fwrite(run, 1, length, out);
+    ringSkip(&ring, length);
+  }
+  fclose(out);
+  session++;
+  slot = (slot + 1) % BLACKBOX_FILES;
+
+  //Every file starts from a fresh codec state so it decodes on its own
+  deltaReset(&delta, BLACKBOX_FIELDS);
+  samples = 0;
+  dropped = 0;
+}
+
+static void blackboxTask(void *ignore) {
+  unsigned long wake = millis();
+
+  while(1) {
+    if(isEnabled()) {
+      blackboxSample();
+    } else if(ringUsed(&ring) > 0) {
+      blackboxFlush();
+    } else if(lcdReadButtons(uart1) == LCD_BTN_CENTER) {
+      blackboxDump();
+      while(lcdReadButtons(uart1) == LCD_BTN_CENTER) {
+        delay(BLACKBOX_PERIOD);
+      }
+    }
+    taskDelayUntil(&wake, BLACKBOX_PERIOD);
+  }
+}
+
+void blackboxInit() {
+  BlackboxHeader header;
+  unsigned char *buffer = arenaAlloc(ARENA_BLACKBOX, BLACKBOX_RING_SIZE);
+  int file;
+
+  if(!buffer) {
+    return;
+  }
+  session = 0;
+  slot = 0;
+  for(file = 0; file < BLACKBOX_FILES; file++) { //Carry on after the newest stored file
+    if(blackboxReadHeader(file, &header) && header.session >= session) {
+      session = header.session + 1;
+      slot = (file + 1) % BLACKBOX_FILES;
+    }
+  }
+
+  ringInit(&ring, buffer, BLACKBOX_RING_SIZE);
+  deltaReset(&delta, BLACKBOX_FIELDS);
+  samples = 0;
+  dropped = 0;
+  taskCreate(blackboxTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+void blackboxDump() {
+  char name[4 + FMT_INT_SIZE];
+  unsigned char buffer[64];
+  size_t length;
+  int i;
+  FILE *in;
+
+  for(i = 0; i < BLACKBOX_FILES; i++) { //The next slot to be written holds the oldest file
+    blackboxName(name, (slot + i) % BLACKBOX_FILES);
+    in = fopen(name, "r");
+    if(!in) {
+      continue;
+    }
+    while((length = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+      fwrite(buffer, 1, length, stdout);
+    }
+    fclose(in);
+  }
+}
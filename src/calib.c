@@ -0,0 +1,110 @@
+/** @file calib.c
+ * @brief File for sensor calibration persisted in flash
+ *
+ * Baselines are kept in 1/16 counts, like the calibration analogReadCalibratedHR() subtracts,
+ * so an integrating sensor loses no precision across a reboot. A zero baseline means none was
+ * ever measured; a real sensor never rests at exactly zero.
+ */
+
+#include "main.h"
+#include <string.h>
+
+//Milliseconds between retries of a save that could not open its file
+#define CALIB_RETRY_PERIOD 500
+
+typedef struct __attribute__((packed)) {
+  char magic[4];                         //CALIB_MAGIC
+  uint16_t crc;                          //frameCrc() of baseline
+  int32_t baseline[BOARD_NR_ADC_PINS];   //Resting value of each channel in 1/16 counts
+} CalibFile;
+
+static CalibFile file;
+static bool dirty;
+
+//Averages readings 1 ms apart into 1/16 counts
+static int calibAverage(unsigned char channel, int samples) {
+  int sum = 0;
+  int i;
+
+  for(i = 0; i < samples; i++) {
+    sum += analogRead(channel);
+    delay(1);
+  }
+  return (sum * 16 + samples / 2) / samples;
+}
+
+bool calibLoad(bool force) {
+  FILE *in;
+  bool valid;
+
+  memset(&file, 0, sizeof(file));
+  dirty = false;
+  if(force) {
+    dirty = true; //Rewrite even if nothing ends up asking for a baseline
+    return false;
+  }
+  in = fopen(CALIB_FILE, "r");
+  if(!in) {
+    return false;
+  }
+  valid = fread(&file, 1, sizeof(file), in) == sizeof(file) &&
+    memcmp(file.magic, CALIB_MAGIC, sizeof(file.magic)) == 0 &&
+    file.crc == frameCrc(file.baseline, sizeof(file.baseline));
+  fclose(in);
+  if(!valid) {
+    memset(&file, 0, sizeof(file));
+  }
+  return valid;
+}
+
+int calibAnalog(unsigned char channel, int below, int above) {
+  int baseline;
+  int sample;
+
+  if(channel < 1 || channel > BOARD_NR_ADC_PINS) {
+    return 0;
+  }
+  baseline = file.baseline[channel - 1];
+  if(baseline != 0) {
+    sample = calibAverage(channel, CALIB_CHECK_SAMPLES);
+    if(sample >= baseline - below * 16 && sample <= baseline + above * 16) {
+      return baseline;
+    }
+  }
+  baseline = calibAverage(channel, CALIB_SAMPLES);
+  if(baseline == 0) { //Keep zero meaning "never measured"
+    baseline = 1;
+  }
+  file.baseline[channel - 1] = baseline;
+  dirty = true;
+  return baseline;
+}
+
+//Returns false, leaving the baselines dirty, if the file could not be opened
+static bool calibWrite() {
+  FILE *out;
+
+  memcpy(file.magic, CALIB_MAGIC, sizeof(file.magic));
+  file.crc = frameCrc(file.baseline, sizeof(file.baseline));
+  out = fopen(CALIB_FILE, "w");
+  if(!out) {
+    return false;
+  }
+  fwrite(&file, sizeof(file), 1, out);
+  fclose(out);
+  dirty = false;
+  return true;
+}
+
+static void calibRetry(void *ignore) {
+  do {
+    delay(CALIB_RETRY_PERIOD);
+  } while(isEnabled() || !calibWrite());
+  taskDelete(NULL);
+}
+
+void calibSave() {
+  if(dirty && !calibWrite()) {
+    taskCreate(calibRetry, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT - 1);
+  }
+}
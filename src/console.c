@@ -0,0 +1,103 @@
+/** @file console.c
+ * @brief File for the serial tuning console
+ *
+ * Answers are built with the fmt routines and written with fputs(), which keeps the full
+ * printf() formatter out of the task.
+ */
+
+#include "main.h"
+#include <string.h>
+
+static FILE *port;
+
+//Returns the text after a command word and its spaces, or NULL if line is not that command
+static const char *consoleCommand(const char *line, const char *word) {
+  int length = strlen(word);
+
+  if(strncmp(line, word, length) != 0 || (line[length] != ' ' && line[length] != '\0')) {
+    return NULL;
+  }
+  for(line += length; *line == ' '; line++);
+  return line;
+}
+
+static void consoleRun(const char *line) {
+  char out[PARAM_FORMAT_SIZE + 7]; //Room for "error: "
+  const char *rest;
+  int index;
+  int i;
+
+  if((rest = consoleCommand(line, "get"))) {
+    index = paramFind(rest);
+    if(index < 0) {
+      fputs("error: no such parameter", port);
+      return;
+    }
+    paramFormat(out, index, false);
+    fputs(out, port);
+  } else if((rest = consoleCommand(line, "set"))) {
+    index = paramAssign(rest);
+    if(index < 0) {
+      index = paramFind(rest);
+      if(index < 0) {
+        fputs("error: no such parameter", port);
+        return;
+      }
+      memcpy(out, "error: ", 7);
+      paramFormat(out + 7, index, true); //Show the bounds the value missed
+      fputs(out, port);
+      return;
+    }
+    paramFormat(out, index, false);
+    fputs(out, port);
+  } else if(consoleCommand(line, "list")) {
+    for(i = 0; i < paramCount(); i++) {
+      paramFormat(out, i, true);
+      fputs(out, port);
+    }
+  } else if(consoleCommand(line, "save")) {
+    if(isEnabled()) {
+      fputs("error: save only while disabled", port);
+    } else {
+      fputs(paramSave() ? "saved" : "error: save failed", port);
+    }
+  } else if(consoleCommand(line, "arena")) {
+    arenaReport(port);
+  } else if(line[0] != '\0') {
+    fputs("error: commands are get NAME, set NAME VALUE, list, save and arena", port);
+  }
+}
+
+static void consoleTask(void *ignore) {
+  char line[CONSOLE_LINE + 1];
+  int length = 0;
+  bool overflow = false;
+  unsigned long wake = millis();
+  int c;
+
+  while(1) {
+    while(fcount(port) > 0) { //Never wait on a byte that has not arrived
+      c = fgetc(port);
+      if(c == '\n' || c == '\r') { //Terminals send either or both
+        line[length] = '\0';
+        if(overflow) {
+          fputs("error: line too long", port);
+        } else {
+          consoleRun(line);
+        }
+        length = 0;
+        overflow = false;
+      } else if(length < CONSOLE_LINE) {
+        line[length++] = (char)c;
+      } else {
+        overflow = true;
+      }
+    }
+    taskDelayUntil(&wake, CONSOLE_PERIOD);
+  }
+}
+
+void consoleInit(FILE *serial) {
+  port = serial;
+  taskCreate(consoleTask, TASK_DEFAULT_STACK_SIZE, NULL, CONSOLE_PRIORITY);
+}
@@ -0,0 +1,76 @@
+/** @file control.cpp
+ * @brief File for the robot's control.h instances and their C wrappers
+ *
+ * Ports come from the PORT_ constants in main.h, the same ones auto.c's motor constants use,
+ * so the two cannot drift apart.
+ */
+
+#include "main.h"
+
+namespace {
+
+typedef control::MotorGroup<PORT_FRONT_LEFT_DRIVE, PORT_BACK_LEFT_DRIVE> LeftDrive;
+//Front right is mounted the other way round
+typedef control::MotorGroup<PORT_BACK_RIGHT_DRIVE, -PORT_FRONT_RIGHT_DRIVE> RightDrive;
+typedef control::MotorGroup<PORT_FLYWHEEL_ONE, PORT_FLYWHEEL_TWO, PORT_FLYWHEEL_THREE,
+  PORT_FLYWHEEL_FOUR> Flywheel;
+
+typedef control::Encoder<3, 4, true> LeftEncoder;
+typedef control::Encoder<5, 6, true> RightEncoder;
+typedef control::Encoder<1, 2, false> SpeedEncoder;
+
+//Replay drift correction: half a joystick unit per drive encoder count, at most 40
+struct SteerGains {
+  static constexpr int kp = 128;
+  static constexpr int ki = 0;
+  static constexpr int kd = 0;
+  static constexpr int shift = 8;
+  static constexpr int limit = 40;
+};
+
+//Counts of the last FLYWHEEL_HISTORY periods, oldest first; only the flywheel task uses it
+control::RingBuffer<int, FLYWHEEL_HISTORY> flywheelCounts;
+control::Pid<SteerGains> steerForward;
+control::Pid<SteerGains> steerTurn;
+
+} // namespace
+
+void controlInit() {
+  left = LeftEncoder::init();
+  right = RightEncoder::init();
+  speedEnc = SpeedEncoder::init();
+}
+
+void controlDrive(int leftPower, int rightPower) {
+  LeftDrive::set(powerApply(POWER_DRIVE_LEFT, thermalApply(THERMAL_LEFT, leftPower)));
+  RightDrive::set(powerApply(POWER_DRIVE_RIGHT, thermalApply(THERMAL_RIGHT, rightPower)));
+}
+
+RAMFUNC void controlFlywheel(int power) {
+  Flywheel::set(power);
+}
+
+void controlFlywheelStart() {
+  int count = SpeedEncoder::get();
+
+  while(flywheelCounts.push(count));
+}
+
+RAMFUNC int controlFlywheelSpeed() {
+  int count = SpeedEncoder::get();
+  int oldest = count;
+
+  flywheelCounts.pop(oldest);
+  flywheelCounts.push(count);
+  return count - oldest;
+}
+
+void controlSteerReset() {
+  steerForward.reset();
+  steerTurn.reset();
+}
+
+void controlSteer(int errorLeft, int errorRight, int *x, int *y) {
+  *y = steerForward.step((errorLeft + errorRight) / 2);
+  *x = steerTurn.step((errorLeft - errorRight) / 2);
+}
@@ -0,0 +1,101 @@
+/** @file delta.c
+ * @brief File for the delta plus varint sample codec
+ *
+ * Differences are zigzag mapped (0, -1, 1, -2, ... to 0, 1, 2, 3, ...) so small negative
+ * steps stay one byte long.
+ */
+
+#include "delta.h"
+
+static unsigned int zigzag(int value) {
+  return ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+}
+
+static int unzigzag(unsigned int value) {
+  return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+int deltaPutVarint(unsigned char *out, unsigned int value) {
+  int count = 0;
+
+  while(value >= 0x80) {
+    out[count++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  out[count++] = (unsigned char)value;
+  return count;
+}
+
+int deltaGetVarint(const unsigned char *in, int length, unsigned int *value) {
+  unsigned int result = 0;
+  int count = 0;
+  int shift;
+
+  for(shift = 0; shift < 35; shift += 7) {
+    if(count >= length) {
+      return -1;
+    }
+    result |= (unsigned int)(in[count] & 0x7F) << shift;
+    if(!(in[count++] & 0x80)) {
+      *value = result;
+      return count;
+    }
+  }
+  return -1;
+}
+
+void deltaReset(Delta *delta, int fields) {
+  int i;
+
+  delta->fields = fields > DELTA_MAX_FIELDS ? DELTA_MAX_FIELDS : fields;
+  for(i = 0; i < DELTA_MAX_FIELDS; i++) {
+    delta->previous[i] = 0;
+  }
+}
+
+int deltaEncode(Delta *delta, const int *values, unsigned char *out) {
+  unsigned int mask = 0;
+  int count;
+  int i;
+
+  for(i = 0; i < delta->fields; i++) {
+    if(values[i] != delta->previous[i]) {
+      mask |= 1u << i;
+    }
+  }
+  count = deltaPutVarint(out, mask);
+  for(i = 0; i < delta->fields; i++) {
+    if(mask & (1u << i)) {
+      //Difference taken as unsigned so a wrapping counter cannot overflow
+      count += deltaPutVarint(out + count,
+        zigzag((int)((unsigned int)values[i] - (unsigned int)delta->previous[i])));
+      delta->previous[i] = values[i];
+    }
+  }
+  return count;
+}
+
+int deltaDecode(Delta *delta, const unsigned char *in, int length, int *values) {
+  unsigned int mask;
+  unsigned int step;
+  int count;
+  int used;
+  int i;
+
+  count = deltaGetVarint(in, length, &mask);
+  if(count < 0 || (mask >> delta->fields) != 0) {
+    return -1;
+  }
+  for(i = 0; i < delta->fields; i++) {
+    if(mask & (1u << i)) {
+      used = deltaGetVarint(in + count, length - count, &step);
+      if(used < 0) {
+        return -1;
+      }
+      count += used;
+      delta->previous[i] = (int)((unsigned int)delta->previous[i] + (unsigned int)unzigzag(step));
+    }
+    values[i] = delta->previous[i];
+  }
+  return count;
+}
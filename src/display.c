@@ -0,0 +1,74 @@
+/** @file display.c
+ * @brief File for the cached LCD renderer
+ *
+ * Posting only stores a label pointer and a number, so it costs a couple of stores in the
+ * control loop. A frame torn by a post in the middle of a render is fixed on the next render.
+ */
+
+#include "main.h"
+#include <string.h>
+
+typedef struct {
+  const char * volatile label; //Text after the value, or the whole line
+  volatile int value;
+  volatile bool hasValue;
+} DisplayLine;
+
+static DisplayLine lines[2];
+static FILE *port;
+
+static void displayRender(const DisplayLine *line, char *out, int size) {
+  const char *label = line->label;
+  int count = 0;
+
+  if(line->hasValue) { //"value label", the same layout the old lcdPrint() calls used
+    count = fmtInt(out, line->value);
+    if(label) {
+      out[count++] = ' ';
+    }
+  }
+  if(label) {
+    count += fmtText(out + count, label, size - 1 - count);
+  }
+  out[count] = '\0';
+}
+
+static void displayTask(void *ignore) {
+  char frame[DISPLAY_WIDTH + 1];
+  char shown[2][DISPLAY_WIDTH + 1] = {"", ""};
+  unsigned char i;
+  unsigned long wake = millis();
+
+  while(1) {
+    for(i = 0; i < 2; i++) {
+      displayRender(&lines[i], frame, sizeof(frame));
+      if(strcmp(frame, shown[i]) != 0) { //Only pay for the UART when the text changed
+        lcdSetText(port, i + 1, frame);
+        strcpy(shown[i], frame);
+      }
+    }
+    taskDelayUntil(&wake, DISPLAY_PERIOD);
+  }
+}
+
+void displayInit(FILE *lcdPort) {
+  port = lcdPort;
+  taskCreate(displayTask, TASK_DEFAULT_STACK_SIZE, NULL, DISPLAY_PRIORITY);
+}
+
+void displayText(unsigned char line, const char *text) {
+  if(line < 1 || line > 2) {
+    return;
+  }
+  lines[line - 1].hasValue = false;
+  lines[line - 1].label = text;
+}
+
+void displayValue(unsigned char line, int value, const char *label) {
+  if(line < 1 || line > 2) {
+    return;
+  }
+  lines[line - 1].value = value;
+  lines[line - 1].label = label;
+  lines[line - 1].hasValue = true;
+}
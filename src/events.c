@@ -0,0 +1,87 @@
+/** @file events.c
+ * @brief File for interrupt-driven digital sensor events
+ *
+ * The interrupt handler is the ring's only producer and the dispatch task its only consumer.
+ * Pin change interrupts all run at the same priority and never nest, so there is only ever
+ * one producer at a time.
+ */
+
+#include "main.h"
+
+//Pins with interrupts, both edges on each
+static const unsigned char eventPins[] = {EVENTS_BALL_PIN};
+
+typedef struct {
+  unsigned char pin;
+  EventHandler handler;
+} EventSubscriber;
+
+static Ring ring;
+static Semaphore pending;
+static EventSubscriber subscribers[EVENTS_MAX_HANDLERS];
+static int subscriberCount;
+
+//Runs in the ISR: stamp, queue and wake the dispatcher, nothing else
+static void eventsInterrupt(unsigned char pin) {
+  Event event;
+
+  event.time = micros();
+  event.pin = pin;
+  event.level = digitalRead(pin) ? HIGH : LOW;
+  event.reserved = 0;
+  ringWrite(&ring, &event, sizeof(event)); //A full queue means 32 edges undispatched; drop it
+  semaphoreGive(pending);
+}
+
+static void eventsTask(void *ignore) {
+  Event event;
+  int i;
+
+  while(1) {
+    semaphoreTake(pending, -1);
+    while(ringRead(&ring, &event, sizeof(event)) == sizeof(event)) {
+      for(i = 0; i < subscriberCount; i++) {
+        if(subscribers[i].pin == event.pin) {
+          subscribers[i].handler(&event);
+        }
+      }
+    }
+  }
+}
+
+void eventsInitIO() {
+  unsigned char *buffer = arenaAlloc(ARENA_EVENTS, EVENTS_QUEUE_SIZE);
+  unsigned int i;
+
+  if(!buffer) {
+    return;
+  }
+  ringInit(&ring, buffer, EVENTS_QUEUE_SIZE);
+  for(i = 0; i < sizeof(eventPins); i++) {
+    pinMode(eventPins[i], INPUT);
+  }
+}
+
+void eventsInit() {
+  unsigned int i;
+
+  if(!ring.buffer) { //No queue, eventsInitIO() could not allocate one
+    return;
+  }
+  pending = semaphoreCreate();
+  semaphoreTake(pending, 0); //Semaphores start given; wait for the first edge
+  taskCreate(eventsTask, TASK_DEFAULT_STACK_SIZE, NULL, EVENTS_PRIORITY);
+  for(i = 0; i < sizeof(eventPins); i++) {
+    ioSetInterrupt(eventPins[i], INTERRUPT_EDGE_BOTH, eventsInterrupt);
+  }
+}
+
+bool eventsSubscribe(unsigned char pin, EventHandler handler) {
+  if(subscriberCount >= EVENTS_MAX_HANDLERS) {
+    return false;
+  }
+  subscribers[subscriberCount].pin = pin;
+  subscribers[subscriberCount].handler = handler;
+  subscriberCount++;
+  return true;
+}
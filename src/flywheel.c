@@ -0,0 +1,118 @@
+/** @file flywheel.c
+ * @brief File for the flywheel speed regulation task
+ *
+ * The flywheel runs the same power ladder the driver loop used to run inline, but at a fixed
+ * FLYWHEEL_PERIOD from a task that outranks autonomous() and operatorControl().
+ */
+
+#include "main.h"
+
+//Stock setpoints: speed, ready tolerance, power just under target, power over target
+const FlywheelTarget flywheelOff = {0, 0, 0, 0};
+FlywheelTarget flywheelLongRange = {83, 1, 127, 51};
+FlywheelTarget flywheelMidRange = {68, 2, 110, 0};
+FlywheelTarget flywheelShortRange = {59, 3, 75, 0};
+
+static FlywheelTarget target;   //Current setpoint, guarded by targetLock
+static Mutex targetLock;
+static volatile int speed;      //Published measured speed
+static volatile int targetSpeed; //Published copy of target.speed for lock-free readers
+static volatile bool ready;     //Published ready flag
+static volatile int shots;      //Published shot count
+static FlywheelCycles cycles;   //Cost of the last pass through each step
+
+//Picks the motor power for a speed; power is the last power, held when exactly on target
+static RAMFUNC int flywheelStep(const FlywheelTarget *now, int measured, int power) {
+  if(now->speed <= 0 || !isEnabled()) { //Off, or the kernel is ignoring motors anyway
+    return 0;
+  } else if(measured > now->speed) {    //Too fast, back off
+    return now->overPower;
+  } else if(measured > now->speed - 5 && measured < now->speed) { //Nearly there, ease in
+    return now->nearPower;
+  } else if(measured < now->speed) {    //Not fast enough, speed up
+    return 127;
+  }
+  return power;
+}
+
+static void flywheelTask(void *ignore) {
+  int power = 0;
+  uint32_t mark;
+  bool armed = false; //Ready since the last counted shot
+  int armedSpeed = 0; //Target speed armed belongs to
+  FlywheelTarget now;
+  unsigned long wake = millis();
+
+  controlFlywheelStart();
+
+  while(1) {
+    mark = ramfuncCycles();
+    speed = controlFlywheelSpeed();
+    cycles.sample = ramfuncCycles() - mark;
+
+    mutexTake(targetLock, -1);
+    now = target;
+    mutexGive(targetLock);
+
+    mark = ramfuncCycles();
+    power = flywheelStep(&now, speed, power);
+    cycles.step = ramfuncCycles() - mark;
+    mark = ramfuncCycles();
+    controlFlywheel(powerApply(POWER_FLYWHEEL, thermalApply(THERMAL_FLYWHEEL, power)));
+    cycles.flush = ramfuncCycles() - mark;
+
+    ready = now.speed > 0 && abs(speed - now.speed) < now.tolerance;
+    if(now.speed != armedSpeed) { //A new target is not a shot
+      armed = false;
+      armedSpeed = now.speed;
+    }
+    if(ready) {
+      armed = true;
+    } else if(armed && speed <= now.speed - FLYWHEEL_SHOT_DIP) { //A ball took the energy
+      shots++;
+      armed = false;
+    }
+    taskDelayUntil(&wake, FLYWHEEL_PERIOD);
+  }
+}
+
+void flywheelInit() {
+  ramfuncCyclesInit();
+  target = flywheelOff;
+  targetLock = mutexCreate();
+  taskCreate(flywheelTask, TASK_DEFAULT_STACK_SIZE, NULL, FLYWHEEL_PRIORITY);
+}
+
+void flywheelSetTarget(const FlywheelTarget *next) {
+  mutexTake(targetLock, -1);
+  if(next->speed != target.speed) { //Old readiness says nothing about a new speed
+    ready = false;
+  }
+  target = *next;
+  targetSpeed = next->speed;
+  mutexGive(targetLock);
+}
+
+int flywheelGetTarget() {
+  return targetSpeed;
+}
+
+int flywheelGetSpeed() {
+  return speed;
+}
+
+bool flywheelReady() {
+  return ready;
+}
+
+bool flywheelWithin(int tolerance) {
+  return abs(speed - targetSpeed) < tolerance;
+}
+
+int flywheelShots() {
+  return shots;
+}
+
+void flywheelGetCycles(FlywheelCycles *out) {
+  *out = cycles;
+}
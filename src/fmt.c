@@ -0,0 +1,118 @@
+/** @file fmt.c
+ * @brief File for the lightweight number formatter
+ *
+ * Digits are produced backwards into a small scratch buffer and copied out, which keeps the
+ * divide count at one per digit and avoids any format string parsing.
+ */
+
+#include "fmt.h"
+
+int fmtUnsigned(char *out, unsigned int value) {
+  char digits[FMT_INT_SIZE];
+  int count = 0;
+  int i;
+
+  do {
+    digits[count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while(value);
+
+  for(i = 0; i < count; i++) {
+    out[i] = digits[count - 1 - i];
+  }
+  out[count] = '\0';
+  return count;
+}
+
+int fmtInt(char *out, int value) {
+  if(value < 0) {
+    out[0] = '-';
+    //Negate as unsigned so INT_MIN does not overflow
+    return 1 + fmtUnsigned(out + 1, 0u - (unsigned int)value);
+  }
+  return fmtUnsigned(out, (unsigned int)value);
+}
+
+int fmtPadded(char *out, int value, int width, char pad) {
+  char number[FMT_INT_SIZE];
+  int length = fmtInt(number, value);
+  int fill = width - length;
+  int count = 0;
+  int i = 0;
+
+  if(fill > 0 && pad == '0' && number[0] == '-') { //Zero padding goes after the sign
+    out[count++] = '-';
+    i = 1;
+  }
+  while(fill-- > 0) {
+    out[count++] = pad;
+  }
+  for(; i < length; i++) {
+    out[count++] = number[i];
+  }
+  out[count] = '\0';
+  return count;
+}
+
+int fmtFixed(char *out, int value, int decimals) {
+  unsigned int magnitude;
+  unsigned int scale = 1;
+  int count = 0;
+  int i;
+
+  if(decimals <= 0) {
+    return fmtInt(out, value);
+  }
+  if(decimals > 9) {
+    decimals = 9;
+  }
+  for(i = 0; i < decimals; i++) {
+    scale *= 10;
+  }
+
+  if(value < 0) {
+    out[count++] = '-';
+    magnitude = 0u - (unsigned int)value;
+  } else {
+    magnitude = (unsigned int)value;
+  }
+
+  count += fmtUnsigned(out + count, magnitude / scale);
+  out[count++] = '.';
+  magnitude %= scale;
+  for(i = count + decimals - 1; i >= count; i--) { //Fraction keeps its leading zeros
+    out[i] = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+  }
+  count += decimals;
+  out[count] = '\0';
+  return count;
+}
+
+int fmtHex(char *out, unsigned int value, int digits) {
+  static const char hex[] = "0123456789ABCDEF";
+  int i;
+
+  if(digits < 1) {
+    digits = 1;
+  } else if(digits > 8) {
+    digits = 8;
+  }
+  for(i = digits - 1; i >= 0; i--) {
+    out[i] = hex[value & 0xF];
+    value >>= 4;
+  }
+  out[digits] = '\0';
+  return digits;
+}
+
+int fmtText(char *out, const char *text, int limit) {
+  int count = 0;
+
+  while(count < limit && text[count]) {
+    out[count] = text[count];
+    count++;
+  }
+  out[count] = '\0';
+  return count;
+}
@@ -0,0 +1,84 @@
+/** @file frame.c
+ * @brief File for COBS framing with a CRC
+ *
+ * Payloads are capped below 254 bytes, so COBS never needs more than its one leading code
+ * byte and FRAME_SIZE() is exact.
+ */
+
+#include "frame.h"
+
+unsigned short frameCrc(const void *data, unsigned int length) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  unsigned short crc = 0xFFFF;
+  int bit;
+
+  while(length--) {
+    crc ^= (unsigned short)(*bytes++ << 8);
+    for(bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (unsigned short)((crc << 1) ^ 0x1021) : (unsigned short)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+unsigned int frameEncode(const void *payload, unsigned int length, unsigned char *out) {
+  const unsigned char *bytes = (const unsigned char *)payload;
+  unsigned short crc;
+  unsigned int code = 0; //Index of the pending COBS code byte
+  unsigned int count = 1;
+  unsigned int i;
+  unsigned char c;
+
+  if(length > FRAME_MAX_PAYLOAD) {
+    return 0;
+  }
+  crc = frameCrc(payload, length);
+  for(i = 0; i < length + 2; i++) {
+    if(i < length) {
+      c = bytes[i];
+    } else {
+      c = (unsigned char)(i == length ? crc & 0xFF : crc >> 8);
+    }
+    if(c == 0) { //Close the block, its code byte points at this zero
+      out[code] = (unsigned char)(count - code);
+      code = count++;
+    } else {
+      out[count++] = c;
+    }
+  }
+  out[code] = (unsigned char)(count - code);
+  out[count++] = 0;
+  return count;
+}
+
+int frameDecode(const unsigned char *frame, unsigned int length, unsigned char *out) {
+  unsigned int i = 0;
+  unsigned int count = 0;
+  unsigned int block;
+  unsigned int crc;
+
+  while(i < length) {
+    block = frame[i++];
+    if(block == 0 || i + block - 1 > length) {
+      return -1;
+    }
+    while(--block) {
+      if(frame[i] == 0) {
+        return -1;
+      }
+      out[count++] = frame[i++];
+    }
+    if(i < length) { //Every block but the last stands for a zero
+      out[count++] = 0;
+    }
+  }
+  if(count < 2) {
+    return -1;
+  }
+  count -= 2;
+  crc = out[count] | (out[count + 1] << 8);
+  if(crc != frameCrc(out, count)) {
+    return -1;
+  }
+  return (int)count;
+}
@@ -0,0 +1,107 @@
+/** @file indexer.c
+ * @brief File for the ball indexer state machine
+ *
+ * Each period the task moves the state on from the sensors, then sets both motors from the
+ * state and the request alone. The intake goes through jamIntake(), so an unjam cycle still
+ * takes precedence over whatever the indexer wants.
+ */
+
+#include "main.h"
+
+static volatile int request;
+static volatile IndexerState state;
+
+static void indexerFeed(int power) {
+  motorSet(ballControl, powerApply(POWER_BALL_CONTROL, power));
+}
+
+//The state the sensors say the conveyor is in when nothing is being fired
+static IndexerState indexerRest() {
+  if(ballPresent()) {
+    return INDEXER_STAGED;
+  }
+  return ballCount() > 0 ? INDEXER_LOADING : INDEXER_EMPTY;
+}
+
+static IndexerState indexerNext(IndexerState now, int want, unsigned long *since) {
+  unsigned long elapsed = millis() - *since;
+
+  switch(now) {
+  case INDEXER_FIRING:
+    if(!ballPresent()) {
+      *since = millis();
+      return INDEXER_RECOVERING;
+    }
+    if(elapsed >= INDEXER_FIRE_TIMEOUT) { //Stuck, back off and try again
+      *since = millis();
+      return INDEXER_RECOVERING;
+    }
+    if(!(want & INDEXER_FIRE) || !flywheelReady()) {
+      return INDEXER_STAGED;
+    }
+    return INDEXER_FIRING;
+  case INDEXER_RECOVERING:
+    if(elapsed < INDEXER_RECOVER_TIME) {
+      return INDEXER_RECOVERING;
+    }
+    break;
+  default:
+    break;
+  }
+  now = indexerRest();
+  if(now == INDEXER_STAGED && (want & INDEXER_FIRE) && flywheelReady()) {
+    *since = millis();
+    return INDEXER_FIRING;
+  }
+  return now;
+}
+
+static void indexerTask(void *ignore) {
+  unsigned long wake = millis();
+  unsigned long since = wake;
+  int want;
+  bool conveyor;
+
+  while(1) {
+    want = isEnabled() ? request : 0;
+    if(want & INDEXER_FORCE) {
+      state = INDEXER_FIRING;
+      jamIntake(127);
+      indexerFeed(127);
+    } else if(want & INDEXER_EJECT) {
+      state = indexerRest();
+      jamIntake(-127);
+      indexerFeed(0);
+    } else {
+      state = indexerNext(state, want, &since);
+      switch(state) {
+      case INDEXER_FIRING: //The next ball follows the one being fired
+        conveyor = true;
+        break;
+      case INDEXER_LOADING:
+      case INDEXER_RECOVERING:
+        conveyor = (want & (INDEXER_LOAD | INDEXER_FIRE)) != 0;
+        break;
+      default: //Pushing more balls behind a staged one only bunches them
+        conveyor = (want & INDEXER_LOAD) != 0;
+        break;
+      }
+      jamIntake(conveyor ? 127 : 0);
+      indexerFeed(state == INDEXER_FIRING ? 127 : 0);
+    }
+    taskDelayUntil(&wake, INDEXER_PERIOD);
+  }
+}
+
+void indexerInit() {
+  state = indexerRest();
+  taskCreate(indexerTask, TASK_DEFAULT_STACK_SIZE, NULL, INDEXER_PRIORITY);
+}
+
+void indexerRequest(int requests) {
+  request = requests;
+}
+
+IndexerState indexerState() {
+  return state;
+}
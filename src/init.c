@@ -43,6 +43,7 @@
  * configure a UART port (usartOpen()) but cannot set up an LCD (lcdInit()).
  */
 void initializeIO() {
+	eventsInitIO();
 }
 
 /*
@@ -61,4 +62,24 @@ void initializeIO() {
 void initialize() {
 	lcdInit(uart1);
 	lcdClear(uart1);
+	displayInit(uart1);
+
+	calibLoad(lcdReadButtons(uart1) == LCD_BTN_LEFT); //Hold left to recalibrate everything
+	paramLoad();
+	controlInit();
+	powerInit();
+	adcInit();
+	ballInit();
+	jamInit();
+	indexerInit();
+	eventsInit();
+	flywheelInit();
+	thermalInit();
+	rangeInit();
+	telemetryInit(TELEMETRY_MIN_PERIOD);
+	blackboxInit();
+	replayInit();
+	consoleInit(stdin); //uart2 carries telemetry
+	calibSave();
+	arenaFreeze(); //Everything after this runs without allocating
 }
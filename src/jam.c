@@ -0,0 +1,125 @@
+/** @file jam.c
+ * @brief File for intake jam detection and recovery
+ *
+ * The monitor keeps the time the current suspicion started: the intake stalled on the IME, or
+ * balls expected to climb that have not reached a tracker. Anything that clears the suspicion
+ * (the commanded power dropping, a ball arriving) restarts the clock. The monitor is the only
+ * task that writes the intake: once a period it sends either the commanded power or the unjam
+ * cycle's override, as API.h asks of a motor shared between tasks.
+ */
+
+#include "main.h"
+
+//IME velocity is internal encoder RPM, this many tenths per output RPM for a 393 on torque gearing
+#define JAM_IME_TENTHS 392
+
+typedef enum {
+  JAM_IDLE = 0,
+  JAM_REVERSE,
+  JAM_FORWARD
+} JamPhase;
+
+static volatile int commanded;
+static volatile JamPhase phase;
+static bool hasIme;
+static JamCounters counters;
+
+static void jamMotor(int power) {
+  motorSet(intake, powerApply(POWER_INTAKE, power));
+}
+
+//Returns true if the intake should be moving and is not
+static bool jamSuspect(unsigned long now, unsigned long *since) {
+  unsigned long idle;
+  int velocity;
+
+  if(!isEnabled() || commanded < JAM_MIN_POWER) {
+    return false;
+  }
+  if(hasIme) {
+    return imeGetVelocity(JAM_IME_ADDRESS, &velocity) &&
+      abs(velocity) * 10 < JAM_STALL_RPM * JAM_IME_TENTHS;
+  }
+  if(ballPresent() || ballCount() < 1) { //Nothing should be climbing
+    return false;
+  }
+  idle = ballIdleTime();
+  if(idle < now - *since) { //A ball arrived since the suspicion started
+    *since = now - idle;
+  }
+  return true;
+}
+
+static void jamTask(void *ignore) {
+  unsigned long wake = millis();
+  unsigned long since = wake;
+  unsigned long phaseEnd = 0;
+  unsigned long cooldownEnd = wake;
+  unsigned long jamTime = wake;
+  unsigned long now;
+  unsigned long limit = hasIme ? JAM_STALL_TIME : JAM_PROGRESS_TIME;
+  int misses = 0;
+
+  while(1) {
+    now = millis();
+    if(misses > 0 && ballIdleTime() < now - jamTime) { //A ball got through after the last cycle
+      misses = 0;
+    }
+    if(phase != JAM_IDLE) {
+      if((long)(now - phaseEnd) >= 0) {
+        if(phase == JAM_REVERSE) {
+          phase = JAM_FORWARD;
+          phaseEnd = now + JAM_FORWARD_TIME;
+        } else {
+          phase = JAM_IDLE;
+          cooldownEnd = now + JAM_COOLDOWN;
+          since = now;
+        }
+      }
+    } else if((long)(now - cooldownEnd) < 0 || !jamSuspect(now, &since)) {
+      since = now;
+    } else if(now - since >= limit) {
+      since = now;
+      jamTime = now;
+      if(!hasIme && misses >= JAM_RETRIES) { //Cycling is not helping, nothing is there
+        ballSetCount(0);
+        counters.stale++;
+        misses = 0;
+      } else {
+        phase = JAM_REVERSE;
+        phaseEnd = now + JAM_REVERSE_TIME;
+        counters.jams++;
+        if(hasIme) {
+          counters.stalls++;
+        }
+        misses++;
+      }
+    }
+    jamMotor(phase == JAM_IDLE ? commanded : (phase == JAM_REVERSE ? -127 : 127));
+    taskDelayUntil(&wake, JAM_PERIOD);
+  }
+}
+
+void jamInit() {
+  hasIme = imeInitializeAll() > JAM_IME_ADDRESS;
+  if(hasIme) {
+    imeReset(JAM_IME_ADDRESS);
+  }
+  taskCreate(jamTask, TASK_DEFAULT_STACK_SIZE, NULL, JAM_PRIORITY);
+}
+
+void jamIntake(int power) {
+  commanded = power;
+}
+
+bool jamActive() {
+  return phase != JAM_IDLE;
+}
+
+bool jamHasIme() {
+  return hasIme;
+}
+
+void jamGetCounters(JamCounters *out) {
+  *out = counters;
+}
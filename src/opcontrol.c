@@ -33,6 +33,110 @@
  */
 
 #include "main.h"
+
+//Tunables, settable from the console (see param.h)
+int driverDeadzone = 20; //Sets joystick deadzone in case of incorrect analog positioning
+
+//Reads the joystick into a snapshot: both drive axes and every button in groups 5 to 8
+void driverRead(DriverInput *input) {
+  unsigned char group;
+  unsigned char button;
+
+  input->x = joystickGetAnalog(1, 1); //Assigns joystick value to X Axis variable
+  input->y = joystickGetAnalog(1, 2); //Assigns joystick value to Y Axis variable
+  input->buttons = 0;
+  for(group = 5; group <= 8; group++) {
+    for(button = JOY_DOWN; button <= JOY_RIGHT; button <<= 1) {
+      if(joystickGetDigital(1, group, button)) {
+        input->buttons |= button << DRIVER_GROUP(group);
+      }
+    }
+  }
+}
+
+//Tests one button bit in a snapshot, so recorded input is read the same way as live input
+bool driverButton(const DriverInput *input, unsigned char group, unsigned char button) {
+  return (input->buttons >> DRIVER_GROUP(group)) & button;
+}
+
+//One tick of driver control from a snapshot; replay.c feeds recorded snapshots through here too
+void driverStep(const DriverInput *input) {
+  //Front Drive motor is toward intake
+  //Flywheel motor numbers are from bottom to top
+  //Flywheel speed itself is regulated by the flywheel task, this only picks the target
+
+  static bool ranging = false; //Whether the flywheel target follows the rangefinder
+  int xAxis = input->x; //Holds X axis for drive analog stick
+  int yAxis = input->y; //Holds Y axis for drive analog stick
+  int requests = 0; //Holds what the indexer is asked to do this tick
+  FlywheelTarget ranged; //Holds the target the rangefinder picks
+    
+
+  /////////
+  //DRIVE//
+  /////////
+  
+  if(abs(xAxis) > driverDeadzone || abs(yAxis) > driverDeadzone){ //Checks to see if joystick is past deadzone, if it is then it engages drive
+    controlDrive(yAxis + xAxis, yAxis - xAxis);
+  } else { //Turns of drive motors if joystick is not being pressed
+    controlDrive(0, 0);
+  }
+  
+
+  ///////////
+  //INDEXER//
+  ///////////
+  
+  //The indexer sequences the intake and ball control; it won't shoot unless a ball is staged
+  //and the flywheel is inside the ready window of its range
+  if(driverButton(input, 5, JOY_DOWN)){ //Left bottom shoulder button loads balls
+    requests |= INDEXER_LOAD;
+  } else if(driverButton(input, 5, JOY_UP)){ //Left top shoulder button ejects them
+    requests |= INDEXER_EJECT;
+  }
+  if(driverButton(input, 6, JOY_DOWN)){ //Right bottom shoulder button fires
+    requests |= INDEXER_FIRE;
+  }
+  if(driverButton(input, 7, JOY_UP)){ //Manual override, feeds regardless of sensors
+    requests |= INDEXER_FORCE;
+  }
+  indexerRequest(requests);
+  
+
+  ////////////
+  //FLYWHEEL//
+  ////////////
+  
+  //The presets and off override the rangefinder until 8 down hands the target back to it
+  if(driverButton(input, 8, JOY_DOWN)){ //Set target speed from the distance to the goal
+    ranging = true;
+  }
+  
+  if(driverButton(input, 8, JOY_UP)){ //Set target speed to long range
+    flywheelSetTarget(&flywheelLongRange);
+    ranging = false;
+  }
+  
+  if(driverButton(input, 8, JOY_LEFT)){ //Set target speed to mid range
+    flywheelSetTarget(&flywheelMidRange);
+    ranging = false;
+  }
+  
+  if(driverButton(input, 8, JOY_RIGHT)){ //Set target speed to short range
+    flywheelSetTarget(&flywheelShortRange);
+    ranging = false;
+  }
+  
+  if(driverButton(input, 7, JOY_DOWN)){ //Set flywheels to off
+    flywheelSetTarget(&flywheelOff);
+    ranging = false;
+  }
+  
+  if(ranging && rangeTarget(&ranged)){ //Keeps the last target while the goal is out of sight
+    flywheelSetTarget(&ranged);
+  }
+}
+
 /*
  * Runs the user operator control code. This function will be started in its own task with the
  * default priority and stack size whenever the robot is enabled via the Field Management System
@@ -50,199 +154,51 @@
  *
  * This task should never exit; it should end with some kind of infinite loop, even if empty.
  */
-Encoder speedEnc;
-int encoderSpeedOp(){
-  int old;
-  int new;
-  
-  old = encoderGet(speedEnc);
-  if(old > 100000){
-    encoderReset(speedEnc);
-    old = 0;
-  }
-  delay(20);
-  new = encoderGet(speedEnc);
-  return new - old;
-}
-
 void operatorControl() {
-  //Front Drive motor is toward intake
-  //Flywheel motor numbers are from bottom to top
-  
-  const int frontLeftDrive = 4;
-  const int frontRightDrive = 7;
-  const int backLeftDrive = 1;
-  const int backRightDrive = 6;
-  const int ballControl = 10;
-  const int flywheelTwo = 2;
-  const int flywheelThree = 3;
-  const int flywheelOne = 9;
-  const int flywheelFour = 8;
-  const int intake = 5;
+  DriverInput input;
+  unsigned long loopStart; //Holds micros() at the top of the loop for telemetry
+  unsigned long wake;
+  int headroom;
 
-  //Range constants
-  const int longRange = 83;
-  const int midRange = 68;
-  const int shortRange = 59;
-  
   //LCD Backlight
   lcdSetBacklight(uart1, true);
   
-  //Encoder Variables/Init
-  if(!speedEnc){
-    speedEnc = encoderInit(1, 2, 0);
-  }
-  
-  encoderReset(speedEnc);
-  int speed = 0;
-  
-  
-  int deadzone = 20; //Sets joystick deadzone in case of incorrect analog positioning
-  int xAxis; //Holds X axis for drive analog stick
-  int yAxis; //Holds Y axis for drive analog stick
-  int intakeForward; //Holds 1 or 0 from one of the left joystick shoulder buttons to tell if the intake should run forward
-  int intakeBackward; //Holds 1 or 0 from other left joystick shoulder button to tell if intake should run backward
-  int targetSpeed = 0;
+  flywheelSetTarget(&flywheelOff);
   
+  wake = millis();
   while (1) {
     
-    speed = encoderSpeedOp(); //Get the flywheel distance
-    lcdPrint(uart1, 1, "%d TargetSpeed", targetSpeed);
-    lcdPrint(uart1, 2, "%d Speed", speed);
-    
-    xAxis = joystickGetAnalog(1, 1); //Assigns joystick value to X Axis variable
-    yAxis = joystickGetAnalog(1, 2); //Assigns joystick value to Y Axis variable
-    
-
-    /////////
-    //DRIVE//
-    /////////
-    
-    if(abs(xAxis) > deadzone || abs(yAxis) > deadzone){ //Checks to see if joystick is past deadzone, if it is then it engages drive
-      motorSet(frontLeftDrive, yAxis + xAxis);
-      motorSet(backLeftDrive, yAxis + xAxis);
-      motorSet(backRightDrive, yAxis - xAxis);
-      motorSet(frontRightDrive, -yAxis + xAxis);
-    } else { //Turns of drive motors if joystick is not being pressed
-      motorSet(frontLeftDrive, 0);
-      motorSet(backLeftDrive, 0);
-      motorSet(backRightDrive, 0);
-      motorSet(frontRightDrive, 0);
+    loopStart = micros();
+    displayValue(1, flywheelGetTarget(), "TargetSpeed");
+    headroom = thermalHeadroom(THERMAL_FLYWHEEL);
+    if(headroom < THERMAL_WARN) { //The flywheel is being held back to save its fuses
+      displayValue(2, headroom, "PTC headroom");
+    } else {
+      displayValue(2, flywheelGetSpeed(), "Speed");
     }
     
+    driverRead(&input);
+    driverStep(&input);
 
     //////////
-    //INTAKE//
+    //RECORD//
     //////////
-    
-    intakeForward = joystickGetDigital(1, 5, JOY_DOWN); //Checks to see if left bottom joystick shoulder button is pressed, if so, it assigns a value of one to intakeForward
-    intakeBackward = joystickGetDigital(1, 5, JOY_UP); //Checks to see if left top joystick shoulder button is pressed if so, it assigns a value of 1 to intakeBackward
-    if(intakeForward){			//Intake
-      motorSet(intake, 127);
-    } else if(intakeBackward){	//Outtake
-      motorSet(intake, -127);
-    } else {					//Stop Conveyor
-      motorSet(intake, 0);
-    }
-    
-
-    /////////////////////
-    //BALL CONTROL LOOP//
-    /////////////////////
-    
-    //If statement for long range shots
-    if((joystickGetDigital(1, 6, JOY_DOWN) && (speed > targetSpeed - 1) && (speed < targetSpeed + 1) && (targetSpeed == longRange)) || joystickGetDigital(1, 7, JOY_UP)){ //Won't the ball shoot unless flywheel is at +- 3 to the correct RPM
-      motorSet(ballControl, 127);
-
-      //If statement for mid range shots
-    } else if ((joystickGetDigital(1, 6, JOY_DOWN) && (speed > targetSpeed - 2) && (speed < targetSpeed + 2) && (targetSpeed == midRange)) || joystickGetDigital(1, 7, JOY_UP)) {
-      motorSet(ballControl, 127);
-
-      //If statement for short range shots
-    } else if ((joystickGetDigital(1, 6, JOY_DOWN) && (speed > targetSpeed - 3) && (speed < targetSpeed + 3) && (targetSpeed == shortRange)) || joystickGetDigital(1, 7, JOY_UP)) {
-      motorSet(ballControl, 127);
-    } else {
-      motorSet(ballControl, 0);
-    }
-    
-
-    ////////////
-    //FLYWHEEL//
-    ////////////
-    
-    if(joystickGetDigital(1, 8, JOY_UP)){ //Set target speed to 85
-      targetSpeed = longRange;
-    }
-    
-    if(joystickGetDigital(1, 8, JOY_LEFT)){ //Set target speed to 69
-      targetSpeed = midRange;
-    }
-    
-    if(joystickGetDigital(1, 8, JOY_RIGHT)){ //Set target speed to 63
-      targetSpeed = shortRange;
+    if(driverButton(&input, 7, JOY_LEFT) && driverButton(&input, 7, JOY_RIGHT) &&
+        !replayRecording()){ //Both 7 side buttons start a new autonomous recording
+      replayRecordStart();
     }
-    
-    if(joystickGetDigital(1, 7, JOY_DOWN)){ //Set flywheels to off
-      targetSpeed = 0;
-    }
-    
-    //Long Range Flywheel Loop
-    if(speed > targetSpeed && targetSpeed == longRange) {
-      motorSet(flywheelOne, 51);
-      motorSet(flywheelTwo, 51);
-      motorSet(flywheelThree, 51);
-      motorSet(flywheelFour, 51);
-    } else if (speed > targetSpeed + 4 && targetSpeed == longRange){
-      motorSet(flywheelOne, 0);
-      motorSet(flywheelTwo, 0);
-      motorSet(flywheelThree, 0);
-      motorSet(flywheelFour, 0);
-    }
-
-    //Mid Range Flywheel Loop
-    else if((speed > targetSpeed - 5) && (speed < targetSpeed) && (targetSpeed == midRange)) {
-      motorSet(flywheelOne, 110);
-      motorSet(flywheelTwo, 110);
-      motorSet(flywheelThree, 110);
-      motorSet(flywheelFour, 110);
-    } else if (speed > targetSpeed && targetSpeed == midRange){
-      motorSet(flywheelOne, 0);
-      motorSet(flywheelTwo, 0);
-      motorSet(flywheelThree, 0);
-      motorSet(flywheelFour, 0);
-    }
-
-    //Short Range Flywheel Loop
-    else if((speed > targetSpeed - 5) && (speed < targetSpeed) && (targetSpeed == shortRange)) {
-      motorSet(flywheelOne, 75);
-      motorSet(flywheelTwo, 75);
-      motorSet(flywheelThree, 75);
-      motorSet(flywheelFour, 75);
-    } else if (speed > targetSpeed && targetSpeed == shortRange){
-      motorSet(flywheelOne, 0);
-      motorSet(flywheelTwo, 0);
-      motorSet(flywheelThree, 0);
-      motorSet(flywheelFour, 0);
-    }
-
-    else if(speed < targetSpeed){ //If flywheel isn't fast enough, speed up
-      motorSet(flywheelOne, 127);
-      motorSet(flywheelTwo, 127);
-      motorSet(flywheelThree, 127);
-      motorSet(flywheelFour, 127);
-    } else if (speed > targetSpeed){
-    	motorSet(flywheelOne, 0);
-    	motorSet(flywheelTwo, 0);
-    	motorSet(flywheelThree, 0);
-    	motorSet(flywheelFour, 0);
+    if(replayRecording()){
+      replayRecord(&input);
+      displayText(1, "RECORDING");
     }
 
     /////////////
     //TEST CODE//
     /////////////
-    if(joystickGetDigital(1, 7, JOY_DOWN)){
-      lcdPrint(uart1, 1, "%d TargetSpeed", encoderGet(speedEnc));
+    if(driverButton(&input, 7, JOY_DOWN)){
+      displayValue(1, encoderGet(speedEnc), "TargetSpeed");
     }
-    delay(20);
+    telemetryLoopTime(micros() - loopStart);
+    taskDelayUntil(&wake, DRIVER_PERIOD); //Fixed rate so recordings replay in step
   }
-}  
+}
@@ -0,0 +1,178 @@
+/** @file param.c
+ * @brief File for the table of parameters tunable without a reflash
+ *
+ * A fixed point parameter is stored as an integer scaled by 10^decimals, the same scaling
+ * fmtFixed() prints, so "0.25" with three decimals is held as 250.
+ */
+
+#include "main.h"
+#include <string.h>
+
+typedef struct {
+  const char *name;        //At most PARAM_NAME characters
+  int *value;              //The variable the control code reads
+  unsigned char decimals;  //0 for an integer, else the fixed point scaling
+  int minimum;             //Bounds in the same scaling as value
+  int maximum;
+} Param;
+
+//Bounds keep a typo from doing damage: speeds stop short of the flywheel's free speed
+static const Param params[] = {
+  {"deadzone", &driverDeadzone, 0, 0, 127},
+  {"long.speed", &flywheelLongRange.speed, 0, 0, 110},
+  {"long.tol", &flywheelLongRange.tolerance, 0, 1, 20},
+  {"long.near", &flywheelLongRange.nearPower, 0, 0, 127},
+  {"long.over", &flywheelLongRange.overPower, 0, 0, 127},
+  {"mid.speed", &flywheelMidRange.speed, 0, 0, 110},
+  {"mid.tol", &flywheelMidRange.tolerance, 0, 1, 20},
+  {"mid.near", &flywheelMidRange.nearPower, 0, 0, 127},
+  {"mid.over", &flywheelMidRange.overPower, 0, 0, 127},
+  {"short.speed", &flywheelShortRange.speed, 0, 0, 110},
+  {"short.tol", &flywheelShortRange.tolerance, 0, 1, 20},
+  {"short.near", &flywheelShortRange.nearPower, 0, 0, 127},
+  {"short.over", &flywheelShortRange.overPower, 0, 0, 127},
+  {"range.smooth", &rangeSmoothing, 3, 50, 1000},
+};
+#define PARAM_COUNT ((int)(sizeof(params) / sizeof(params[0])))
+
+static volatile unsigned int changes;
+
+//Parses a decimal number with up to decimals digits after the point, scaled by 10^decimals
+static bool paramParse(const char *text, int decimals, int *value) {
+  int result = 0;
+  int digits = 0;
+  int places = -1; //Digits seen after the point, -1 before it
+  bool negative = *text == '-';
+
+  if(negative) {
+    text++;
+  }
+  for(; *text && *text != ' '; text++) {
+    if(*text == '.' && places < 0 && decimals > 0) {
+      places = 0;
+    } else if(*text >= '0' && *text <= '9' && digits < 9 && places < decimals) {
+      result = result * 10 + (*text - '0');
+      digits++;
+      if(places >= 0) {
+        places++;
+      }
+    } else {
+      return false;
+    }
+  }
+  if(digits == 0) {
+    return false;
+  }
+  for(places = places < 0 ? 0 : places; places < decimals; places++) {
+    result *= 10;
+  }
+  *value = negative ? -result : result;
+  return true;
+}
+
+int paramLoad() {
+  static char text[PARAM_FILE_SIZE + 1];
+  FILE *in = fopen(PARAM_FILE, "r");
+  char *line;
+  char *end;
+  int length;
+  int loaded = 0;
+
+  if(!in) {
+    return 0;
+  }
+  length = fread(text, 1, PARAM_FILE_SIZE, in);
+  fclose(in);
+  text[length > 0 ? length : 0] = '\0';
+  for(line = text; *line; line = end) {
+    end = strchr(line, '\n');
+    if(end) {
+      *end++ = '\0';
+    } else {
+      end = line + strlen(line);
+    }
+    if(paramAssign(line) >= 0) {
+      loaded++;
+    }
+  }
+  return loaded;
+}
+
+bool paramSave() {
+  char line[PARAM_FORMAT_SIZE];
+  FILE *out;
+  int length;
+  int i;
+
+  if(isEnabled()) { //A flash write stalls every task, so never with the motors live
+    return false;
+  }
+  out = fopen(PARAM_FILE, "w");
+  if(!out) {
+    return false;
+  }
+  for(i = 0; i < PARAM_COUNT; i++) {
+    length = paramFormat(line, i, false);
+    line[length++] = '\n';
+    fwrite(line, 1, length, out);
+  }
+  fclose(out);
+  return true;
+}
+
+int paramCount() {
+  return PARAM_COUNT;
+}
+
+int paramFind(const char *name) {
+  int length;
+  int i;
+
+  for(length = 0; name[length] && name[length] != ' '; length++);
+  for(i = 0; i < PARAM_COUNT; i++) {
+    if(strncmp(params[i].name, name, length) == 0 && params[i].name[length] == '\0') {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int paramAssign(const char *line) {
+  const char *value = strchr(line, ' ');
+  int index = paramFind(line);
+  int parsed;
+
+  if(index < 0 || !value) {
+    return -1;
+  }
+  while(*value == ' ') {
+    value++;
+  }
+  if(!paramParse(value, params[index].decimals, &parsed) || parsed < params[index].minimum ||
+      parsed > params[index].maximum) {
+    return -1;
+  }
+  *params[index].value = parsed;
+  changes++;
+  return index;
+}
+
+int paramFormat(char *out, int index, bool bounds) {
+  const Param *param = &params[index];
+  int count = fmtText(out, param->name, PARAM_NAME);
+
+  out[count++] = ' ';
+  count += fmtFixed(out + count, *param->value, param->decimals);
+  if(bounds) {
+    count += fmtText(out + count, " (", 2);
+    count += fmtFixed(out + count, param->minimum, param->decimals);
+    count += fmtText(out + count, " to ", 4);
+    count += fmtFixed(out + count, param->maximum, param->decimals);
+    count += fmtText(out + count, ")", 1);
+  }
+  return count;
+}
+
+unsigned int paramChanges() {
+  return changes;
+}
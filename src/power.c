@@ -0,0 +1,232 @@
+/** @file power.c
+ * @brief File for brownout prediction and load shedding
+ *
+ * Load is counted in motor power units: a group asked for power p on n motors is n * |p|, so
+ * one motor at full power is 127. The resting voltage is only learnt while the load is light,
+ * and the sag per motor only while it is heavy. The sag follows rises at once and falls back
+ * slowly, because a spinning motor draws less than one starting up and the prediction has to
+ * cover the start.
+ */
+
+#include "main.h"
+
+//Load below which the battery counts as resting, half a motor
+#define POWER_IDLE_LOAD 64
+//Load above which the sag per motor is fitted, two motors
+#define POWER_FIT_LOAD 254
+
+typedef struct {
+  const char *name;
+  unsigned char motors;
+  unsigned char priority;
+  unsigned char minimum;
+} PowerLoadInfo;
+
+//One logged cut
+typedef struct {
+  uint32_t time;      //millis()
+  uint16_t predicted; //Millivolts the asked-for load would have pulled the battery down to
+  uint16_t measured;  //Millivolts at the time
+  uint8_t load;       //PowerLoad cut
+  uint8_t allowance;  //What it was cut to, in 128ths
+  uint16_t reserved;
+} PowerLog;
+
+#define POWER_LOAD_INFO(id, name, motors, priority, minimum) {name, motors, priority, minimum},
+static const PowerLoadInfo loads[POWER_LOADS] = {
+  POWER_LOAD_LIST(POWER_LOAD_INFO)
+};
+#undef POWER_LOAD_INFO
+
+static volatile int requested[POWER_LOADS]; //|power| asked for
+static volatile int allowance[POWER_LOADS]; //In 128ths
+static Ring ring;
+static volatile unsigned int minimumMain = 0xFFFF;
+static unsigned int minimumBackup = 0xFFFF;
+static volatile unsigned int interventions;
+static int rest;                            //Resting voltage in 1/16 mV
+static int sag = POWER_DEFAULT_SAG << 4;    //Sag per motor at full power in 1/16 mV
+
+//Updates the battery model from one sample
+static void powerFit(int level, int applied) {
+  int sample;
+
+  if(applied < POWER_IDLE_LOAD) {
+    rest += ((level << 4) - rest) >> 3;
+  } else if(applied >= POWER_FIT_LOAD) {
+    sample = (rest - (level << 4)) * 127 / applied;
+    if(sample > sag) {
+      sag = sample;
+    } else {
+      sag += (sample - sag) >> 6;
+    }
+    if(sag < 16) { //Never predict a free lunch
+      sag = 16;
+    }
+  }
+}
+
+//Works out each group's allowance so the predicted voltage stays above floor
+static void powerBudget(int floor, int load, int *target) {
+  int budget = rest > floor << 4 ? ((rest - (floor << 4)) * 127) / sag : 0;
+  int excess = load - budget;
+  int priority;
+  int groupLoad;
+  int cut;
+  int i;
+
+  for(i = 0; i < POWER_LOADS; i++) {
+    target[i] = 128;
+  }
+  for(priority = 0; excess > 0 && priority <= 0xFF; priority++) { //Priorities are bytes
+    groupLoad = 0;
+    for(i = 0; i < POWER_LOADS; i++) {
+      if(loads[i].priority == priority) {
+        groupLoad += requested[i] * loads[i].motors;
+      }
+    }
+    if(groupLoad == 0) {
+      continue;
+    }
+    cut = excess < groupLoad ? excess : groupLoad;
+    for(i = 0; i < POWER_LOADS; i++) {
+      if(loads[i].priority == priority) {
+        target[i] = 128 - 128 * cut / groupLoad; //Share the cut across the priority
+        if(target[i] < loads[i].minimum) {
+          target[i] = loads[i].minimum;
+        }
+        excess -= requested[i] * loads[i].motors * (128 - target[i]) / 128;
+      }
+    }
+  }
+}
+
+//Prints the queued cuts and the lowest voltages; the log's only reader
+static void powerReport() {
+  char line[96];
+  PowerLog entry;
+  bool printed = false;
+  int count;
+
+  while(ringRead(&ring, &entry, sizeof(entry)) == sizeof(entry)) {
+    count = fmtText(line, "power ", 6);
+    count += fmtUnsigned(line + count, entry.time);
+    count += fmtText(line + count, " cut ", 5);
+    count += fmtText(line + count, loads[entry.load].name, 8);
+    count += fmtText(line + count, " to ", 4);
+    count += fmtUnsigned(line + count, entry.allowance);
+    count += fmtText(line + count, "/128, predicted ", 16);
+    count += fmtUnsigned(line + count, entry.predicted);
+    count += fmtText(line + count, " mV at ", 7);
+    count += fmtUnsigned(line + count, entry.measured);
+    fmtText(line + count, " mV", 3);
+    fputs(line, stdout);
+    printed = true;
+  }
+  if(printed) {
+    count = fmtText(line, "power minimum main ", 19);
+    count += fmtUnsigned(line + count, minimumMain);
+    count += fmtText(line + count, " mV backup ", 11);
+    count += fmtUnsigned(line + count, minimumBackup);
+    fmtText(line + count, " mV", 3);
+    fputs(line, stdout);
+  }
+}
+
+static void powerReporter(void *ignore) {
+  unsigned long wake = millis();
+
+  while(1) {
+    if(!isEnabled()) {
+      powerReport();
+    }
+    taskDelayUntil(&wake, POWER_REPORT_PERIOD);
+  }
+}
+
+static void powerTask(void *ignore) {
+  unsigned long wake = millis();
+  int target[POWER_LOADS];
+  PowerLog entry;
+  int level;
+  int backup;
+  int load;
+  int applied;
+  int floor;
+  int i;
+
+  rest = powerLevelMain() << 4;
+  while(1) {
+    level = powerLevelMain();
+    backup = powerLevelBackup();
+    load = 0;
+    applied = 0;
+    if(isEnabled()) { //Disabled motors draw nothing whatever they were last asked
+      for(i = 0; i < POWER_LOADS; i++) {
+        load += requested[i] * loads[i].motors;
+        applied += requested[i] * loads[i].motors * allowance[i] / 128;
+      }
+      if((unsigned int)level < minimumMain) {
+        minimumMain = level;
+      }
+      if((unsigned int)backup < minimumBackup) {
+        minimumBackup = backup;
+      }
+    }
+    powerFit(level, applied);
+    floor = backup > POWER_BACKUP_MIN ? POWER_FLOOR_BACKUP : POWER_FLOOR;
+    powerBudget(floor, load, target);
+
+    for(i = 0; i < POWER_LOADS; i++) {
+      if(target[i] < allowance[i]) {
+        if(allowance[i] == 128) { //A new cut rather than a deeper one
+          interventions++;
+          entry.time = millis();
+          entry.predicted = (uint16_t)((rest - sag * load / 127) >> 4);
+          entry.measured = (uint16_t)level;
+          entry.load = (uint8_t)i;
+          entry.allowance = (uint8_t)target[i];
+          entry.reserved = 0;
+          ringWrite(&ring, &entry, sizeof(entry)); //A full log just loses the entry
+        }
+        allowance[i] = target[i];
+      } else {
+        allowance[i] = allowance[i] + POWER_RESTORE < target[i] ? allowance[i] + POWER_RESTORE :
+          target[i];
+      }
+    }
+    taskDelayUntil(&wake, POWER_PERIOD);
+  }
+}
+
+void powerInit() {
+  unsigned char *buffer = arenaAlloc(ARENA_POWER, POWER_LOG_SIZE);
+  int i;
+
+  for(i = 0; i < POWER_LOADS; i++) {
+    allowance[i] = 128;
+  }
+  if(!buffer) {
+    return;
+  }
+  ringInit(&ring, buffer, POWER_LOG_SIZE);
+  taskCreate(powerTask, TASK_DEFAULT_STACK_SIZE, NULL, POWER_PRIORITY);
+  taskCreate(powerReporter, TASK_DEFAULT_STACK_SIZE, NULL, POWER_REPORT_PRIORITY);
+}
+
+RAMFUNC int powerApply(PowerLoad load, int power) {
+  requested[load] = abs(power);
+  return power * allowance[load] / 128;
+}
+
+int powerAllowance(PowerLoad load) {
+  return allowance[load];
+}
+
+unsigned int powerMinimum() {
+  return minimumMain;
+}
+
+unsigned int powerInterventions() {
+  return interventions;
+}
@@ -0,0 +1,128 @@
+/** @file range.c
+ * @brief File for the ultrasonic rangefinder and range to flywheel speed table
+ *
+ * The filtered distance is kept in 1/16 cm and by default moves a quarter of the way to each
+ * median, so it settles within about four samples (200 ms) of the robot stopping.
+ */
+
+#include "main.h"
+
+//Farthest reading the sensor gives reliably; anything past it is a missed echo
+#define RANGE_MAX 400
+
+typedef struct {
+  int cm;                       //Distance to the goal
+  const FlywheelTarget *target; //Setpoint that scores from there
+} RangeRow;
+
+//Rows by increasing distance, at the spots the driver presets were tuned from
+static const RangeRow rangeTable[] = {
+  {90, &flywheelShortRange},
+  {180, &flywheelMidRange},
+  {330, &flywheelLongRange},
+};
+#define RANGE_ROWS (sizeof(rangeTable) / sizeof(rangeTable[0]))
+
+static Ultrasonic sonar;
+static volatile int filtered;           //In 1/16 cm
+static volatile unsigned long lastGood;
+static volatile bool seen;              //Whether there has been any good reading
+
+int rangeSmoothing = 250;
+
+static int rangeMedian(int a, int b, int c) {
+  int t;
+
+  if(a > b) {
+    t = a;
+    a = b;
+    b = t;
+  }
+  if(b > c) {
+    b = c;
+  }
+  return a > b ? a : b;
+}
+
+static void rangeTask(void *ignore) {
+  unsigned long wake = millis();
+  int window[3];
+  int slot = 0;
+  int reading;
+  int i;
+
+  while(1) {
+    reading = ultrasonicGet(sonar);
+    if(reading > 0 && reading <= RANGE_MAX) {
+      if(!seen || millis() - lastGood >= RANGE_STALE) { //Start afresh, the robot has moved
+        for(i = 0; i < 3; i++) {
+          window[i] = reading;
+        }
+        filtered = reading << 4;
+        seen = true;
+      }
+      window[slot] = reading;
+      slot = (slot + 1) % 3;
+      filtered += ((rangeMedian(window[0], window[1], window[2]) << 4) - filtered) *
+        rangeSmoothing / 1000;
+      lastGood = millis();
+    }
+    taskDelayUntil(&wake, RANGE_PERIOD);
+  }
+}
+
+//Linear interpolation from a at 0 to b at span, rounded to nearest
+static int rangeLerp(int a, int b, int at, int span) {
+  int scaled = (b - a) * at * 2;
+
+  return a + (scaled + (scaled < 0 ? -span : span)) / (2 * span);
+}
+
+void rangeInit() {
+  sonar = ultrasonicInit(RANGE_ECHO_PORT, RANGE_PING_PORT);
+  if(!sonar) {
+    return;
+  }
+  taskCreate(rangeTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+bool rangeGet(int *cm) {
+  if(!seen || millis() - lastGood >= RANGE_STALE) {
+    return false;
+  }
+  *cm = (filtered + 8) >> 4;
+  return true;
+}
+
+bool rangeTarget(FlywheelTarget *target) {
+  static FlywheelTarget current;
+  static int computedAt;
+  static unsigned int computedChanges; //paramChanges() when current was computed
+  static bool computed = false;
+  const RangeRow *low;
+  const RangeRow *high;
+  int cm;
+  int at;
+  int span;
+  unsigned int row;
+
+  if(!rangeGet(&cm)) {
+    return false;
+  }
+  if(!computed || abs(cm - computedAt) >= RANGE_DEADBAND || computedChanges != paramChanges()) {
+    for(row = 1; row < RANGE_ROWS - 1 && cm > rangeTable[row].cm; row++);
+    low = &rangeTable[row - 1];
+    high = &rangeTable[row];
+    span = high->cm - low->cm;
+    at = cm < low->cm ? 0 : (cm > high->cm ? span : cm - low->cm); //Clamp to the table's ends
+    current.speed = rangeLerp(low->target->speed, high->target->speed, at, span);
+    current.tolerance = rangeLerp(low->target->tolerance, high->target->tolerance, at, span);
+    current.nearPower = rangeLerp(low->target->nearPower, high->target->nearPower, at, span);
+    current.overPower = rangeLerp(low->target->overPower, high->target->overPower, at, span);
+    computedAt = cm;
+    computedChanges = paramChanges();
+    computed = true;
+  }
+  *target = current;
+  return true;
+}
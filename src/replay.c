@@ -0,0 +1,255 @@
+/** @file replay.c
+ * @brief File for driver input record and replay
+ *
+ * A take is a sequence of (run length varint, delta.h sample) pairs: each distinct tick is
+ * stored once along with how many ticks in a row it lasted. Drive encoders only change in the
+ * sample on checkpoint ticks so a steady stick still produces long runs.
+ */
+
+#include "main.h"
+#include <string.h>
+
+//Sample fields
+enum {REPLAY_X, REPLAY_Y, REPLAY_BUTTONS, REPLAY_TARGET, REPLAY_LEFT, REPLAY_RIGHT,
+  REPLAY_FIELDS};
+
+//Saver period, and how many disabled periods to wait so operatorControl() is surely gone
+#define REPLAY_SAVE_PERIOD 100
+#define REPLAY_SAVE_DELAY 2
+
+typedef struct __attribute__((packed)) {
+  char magic[4];       //REPLAY_MAGIC
+  uint16_t period;     //DRIVER_PERIOD when recorded
+  uint16_t checkpoint; //REPLAY_CHECKPOINT when recorded
+  uint32_t ticks;      //Ticks stored
+  uint32_t length;     //Encoded bytes after the header
+} ReplayHeader;
+
+//Stock flywheel setpoints a take can ask for
+static const FlywheelTarget *const replayTargets[] = {
+  &flywheelOff, &flywheelLongRange, &flywheelMidRange, &flywheelShortRange
+};
+
+static unsigned char *take;          //REPLAY_BUFFER bytes from the arena
+static unsigned int length;          //Encoded bytes in take
+static unsigned int stored;          //Ticks encoded in take
+static unsigned int ticks;           //Ticks recorded or played so far
+static unsigned int offset;          //Playback read position
+static Delta delta;
+static int current[REPLAY_FIELDS];   //Tick waiting to be encoded, or being played
+static unsigned int run;             //Ticks left of current
+static int correctX;
+static int correctY;
+static volatile bool recording;
+static volatile bool unsaved;
+
+static int replayClamp(int value, int limit) {
+  if(value > limit) {
+    return limit;
+  }
+  if(value < -limit) {
+    return -limit;
+  }
+  return value;
+}
+
+//Stores current and its run, returns false if the take is full
+static bool replayEmit() {
+  if(length + 5 + DELTA_MAX_SIZE > REPLAY_BUFFER) {
+    return false;
+  }
+  length += deltaPutVarint(take + length, run);
+  length += deltaEncode(&delta, current, take + length);
+  stored += run;
+  return true;
+}
+
+static void replayStop() {
+  if(run > 0) {
+    replayEmit();
+  }
+  run = 0;
+  recording = false;
+  unsaved = true;
+}
+
+static void replaySave() {
+  ReplayHeader header;
+  FILE *out;
+
+  memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+  header.period = DRIVER_PERIOD;
+  header.checkpoint = REPLAY_CHECKPOINT;
+  header.ticks = stored;
+  header.length = length;
+
+  out = fopen(REPLAY_FILE, "w");
+  if(!out) { //Still unsaved, so the saver tries again
+    return;
+  }
+  fwrite(&header, sizeof(header), 1, out);
+  fwrite(take, 1, length, out);
+  fclose(out);
+  unsaved = false;
+}
+
+static void replaySaver(void *ignore) {
+  int disabled = 0;
+
+  while(1) {
+    if(isEnabled()) {
+      disabled = 0;
+    } else if(++disabled >= REPLAY_SAVE_DELAY) {
+      if(recording) {
+        replayStop();
+      }
+      if(unsaved) {
+        replaySave();
+      }
+    }
+    delay(REPLAY_SAVE_PERIOD);
+  }
+}
+
+void replayInit() {
+  recording = false;
+  unsaved = false;
+  take = arenaAlloc(ARENA_REPLAY, REPLAY_BUFFER);
+  if(!take) {
+    return;
+  }
+  taskCreate(replaySaver, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT - 1);
+}
+
+void replayRecordStart() {
+  if(!take) {
+    return;
+  }
+  encoderReset(left);
+  encoderReset(right);
+  deltaReset(&delta, REPLAY_FIELDS);
+  memset(current, 0, sizeof(current));
+  length = 0;
+  stored = 0;
+  ticks = 0;
+  run = 0;
+  unsaved = false;
+  recording = true;
+}
+
+bool replayRecording() {
+  return recording;
+}
+
+void replayRecord(const DriverInput *input) {
+  int values[REPLAY_FIELDS];
+
+  if(!recording) {
+    return;
+  }
+  values[REPLAY_X] = input->x;
+  values[REPLAY_Y] = input->y;
+  values[REPLAY_BUTTONS] = input->buttons;
+  values[REPLAY_TARGET] = flywheelGetTarget();
+  if(ticks % REPLAY_CHECKPOINT == 0) {
+    values[REPLAY_LEFT] = encoderGet(left);
+    values[REPLAY_RIGHT] = encoderGet(right);
+  } else {
+    values[REPLAY_LEFT] = current[REPLAY_LEFT];
+    values[REPLAY_RIGHT] = current[REPLAY_RIGHT];
+  }
+
+  if(run > 0 && memcmp(values, current, sizeof(values)) == 0) {
+    run++;
+  } else {
+    if(run > 0 && !replayEmit()) { //Out of room, keep what fits
+      run = 0;
+      replayStop();
+      return;
+    }
+    memcpy(current, values, sizeof(values));
+    run = 1;
+  }
+  ticks++;
+  if(ticks * DRIVER_PERIOD >= REPLAY_LENGTH) {
+    replayStop();
+  }
+}
+
+bool replayLoad() {
+  ReplayHeader header;
+  FILE *in;
+  bool valid;
+
+  if(recording || !take) {
+    return false;
+  }
+  in = fopen(REPLAY_FILE, "r");
+  if(!in) {
+    return false;
+  }
+  valid = fread(&header, 1, sizeof(header), in) == sizeof(header) &&
+    memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) == 0 &&
+    header.period == DRIVER_PERIOD && header.checkpoint == REPLAY_CHECKPOINT &&
+    header.length <= REPLAY_BUFFER && fread(take, 1, header.length, in) == header.length;
+  fclose(in);
+  if(!valid) {
+    length = 0;
+    return false;
+  }
+
+  length = header.length;
+  stored = header.ticks;
+  offset = 0;
+  ticks = 0;
+  run = 0;
+  correctX = 0;
+  correctY = 0;
+  controlSteerReset();
+  deltaReset(&delta, REPLAY_FIELDS);
+  encoderReset(left);
+  encoderReset(right);
+  return true;
+}
+
+bool replayNext(DriverInput *input) {
+  unsigned int count;
+  int errorLeft;
+  int errorRight;
+  int used;
+  unsigned int i;
+
+  if(run == 0) {
+    used = offset < length ? deltaGetVarint(take + offset, length - offset, &count) : -1;
+    if(used < 0 || count == 0) {
+      return false;
+    }
+    offset += used;
+    used = deltaDecode(&delta, take + offset, length - offset, current);
+    if(used < 0) {
+      return false;
+    }
+    offset += used;
+    run = count;
+  }
+  run--;
+
+  if(ticks % REPLAY_CHECKPOINT == 0) { //Steer back towards where the recording was
+    errorLeft = current[REPLAY_LEFT] - encoderGet(left);
+    errorRight = current[REPLAY_RIGHT] - encoderGet(right);
+    controlSteer(errorLeft, errorRight, &correctX, &correctY);
+  }
+  ticks++;
+
+  if(current[REPLAY_TARGET] != flywheelGetTarget()) { //Catch up on a target picked before
+    for(i = 0; i < sizeof(replayTargets) / sizeof(replayTargets[0]); i++) {
+      if(replayTargets[i]->speed == current[REPLAY_TARGET]) {
+        flywheelSetTarget(replayTargets[i]);
+      }
+    }
+  }
+  input->x = replayClamp(current[REPLAY_X] + correctX, 127);
+  input->y = replayClamp(current[REPLAY_Y] + correctY, 127);
+  input->buttons = current[REPLAY_BUTTONS];
+  return true;
+}
@@ -0,0 +1,77 @@
+/** @file ring.c
+ * @brief File for the lock-free byte ring
+ *
+ * Each side publishes its counter only after the bytes it covers are in place. The Cortex-M3
+ * is single core, so a compiler barrier is enough to keep that order.
+ */
+
+#include <string.h>
+
+#include "ring.h"
+
+#define ringBarrier() __asm__ volatile("" ::: "memory")
+
+void ringInit(Ring *ring, unsigned char *buffer, unsigned int size) {
+  ring->buffer = buffer;
+  ring->size = size;
+  ring->head = 0;
+  ring->tail = 0;
+}
+
+unsigned int ringUsed(const Ring *ring) {
+  return ring->head - ring->tail;
+}
+
+unsigned int ringFree(const Ring *ring) {
+  return ring->size - (ring->head - ring->tail);
+}
+
+bool ringWrite(Ring *ring, const void *data, unsigned int length) {
+  unsigned int head = ring->head;
+  unsigned int offset = head & (ring->size - 1);
+  unsigned int first = ring->size - offset;
+
+  if(length > ring->size - (head - ring->tail)) {
+    return false;
+  }
+  if(first > length) {
+    first = length;
+  }
+  memcpy(ring->buffer + offset, data, first);
+  memcpy(ring->buffer, (const unsigned char *)data + first, length - first);
+  ringBarrier();
+  ring->head = head + length;
+  return true;
+}
+
+unsigned int ringPeek(const Ring *ring, const unsigned char **data) {
+  unsigned int tail = ring->tail;
+  unsigned int used = ring->head - tail;
+  unsigned int offset = tail & (ring->size - 1);
+  unsigned int first = ring->size - offset;
+
+  ringBarrier();
+  *data = ring->buffer + offset;
+  return used < first ? used : first;
+}
+
+void ringSkip(Ring *ring, unsigned int length) {
+  ringBarrier();
+  ring->tail += length;
+}
+
+unsigned int ringRead(Ring *ring, void *data, unsigned int length) {
+  const unsigned char *run;
+  unsigned int count = 0;
+  unsigned int chunk;
+
+  while(count < length && (chunk = ringPeek(ring, &run)) > 0) {
+    if(chunk > length - count) {
+      chunk = length - count;
+    }
+    memcpy((unsigned char *)data + count, run, chunk);
+    ringSkip(ring, chunk);
+    count += chunk;
+  }
+  return count;
+}
@@ -0,0 +1,200 @@
+/** @file script.c
+ * @brief File for the autonomous script engine
+ *
+ * Motions use the same encoder exit conditions and full power drive the old blocking
+ * forwardIntake(), rightTurn() and leftTurn() loops used.
+ */
+
+#include "main.h"
+
+//Most instant steps run in one tick, guards against a script that jumps in a loop
+#define AUTO_MAX_INSTANT 32
+
+static void autoMotionStart(AutoEngine *engine, int dist, int turn) {
+  encoderReset(left);
+  encoderReset(right);
+  engine->motion = dist;
+  engine->turn = turn;
+}
+
+//Runs the current motion for one tick, returns true while it is still moving
+static bool autoMotion(AutoEngine *engine) {
+  int dist = engine->motion;
+  bool moving;
+
+  if(dist == 0) {
+    return false;
+  }
+  if(engine->turn > 0) {
+    moving = encoderGet(left) < dist && encoderGet(right) > -dist;
+    controlDrive(127, -127);
+  } else if(engine->turn < 0) {
+    moving = encoderGet(left) > -dist && encoderGet(right) < dist;
+    controlDrive(-127, 127);
+  } else {
+    moving = encoderGet(left) < dist && encoderGet(right) < dist;
+    controlDrive(127, 127);
+  }
+  if(!moving) {
+    controlDrive(0, 0);
+    encoderReset(left);
+    encoderReset(right);
+    engine->motion = 0;
+  }
+  return moving;
+}
+
+unsigned long autoRemaining(const AutoEngine *engine) {
+  unsigned long elapsed = millis() - engine->start;
+
+  return elapsed < engine->routine->budget ? engine->routine->budget - elapsed : 0;
+}
+
+//Sums the estimates of the phases after pc, either all of them or those worth more than value
+static unsigned long autoReserve(const AutoEngine *engine, int pc, int value, bool all) {
+  const AutoStep *step;
+  const AutoPhase *phase;
+  unsigned long reserve = 0;
+
+  for(step = &engine->program[pc]; step->op != AUTO_END; step++) {
+    if(step->op == AUTO_PHASE) {
+      phase = &engine->routine->phases[step->arg];
+      if(all || phase->value > value) {
+        reserve += phase->estimate;
+      }
+    }
+  }
+  return reserve;
+}
+
+//Moves pc to the next AUTO_PHASE or AUTO_END, abandoning whatever the phase was doing
+static void autoSkipPhase(AutoEngine *engine) {
+  const AutoStep *step = &engine->program[engine->pc];
+
+  do {
+    step++;
+  } while(step->op != AUTO_PHASE && step->op != AUTO_END);
+  engine->pc = step - engine->program;
+  engine->started = false;
+  engine->motion = 0;
+  controlDrive(0, 0);
+  indexerRequest(0);
+}
+
+//Whether the current phase must give way to the phases after it
+static bool autoOutOfTime(const AutoEngine *engine) {
+  unsigned long remaining = autoRemaining(engine);
+
+  if(remaining == 0 || remaining <= engine->reserve) {
+    return true;
+  }
+  //Past its own estimate a phase stops borrowing from any later phase
+  return millis() - engine->phaseStart >= engine->phaseEstimate &&
+    remaining <= engine->reserveAll;
+}
+
+void autoStart(AutoEngine *engine, const AutoRoutine *routine, int side) {
+  engine->routine = routine;
+  engine->program = routine->program;
+  engine->side = side;
+  engine->pc = 0;
+  engine->started = false;
+  engine->motion = 0;
+  engine->turn = 0;
+  engine->start = millis();
+  engine->phaseStart = engine->start;
+  engine->phaseEstimate = routine->budget;
+  engine->reserve = 0;
+  engine->reserveAll = 0;
+  controlDrive(0, 0);
+  encoderReset(left);
+  encoderReset(right);
+}
+
+bool autoStep(AutoEngine *engine) {
+  const AutoStep *step;
+  const AutoPhase *phase;
+  int instant = 0;
+  bool waiting = false;
+
+  //Background motion runs every tick, whatever the script is doing
+  autoMotion(engine);
+
+  while(!waiting && instant++ < AUTO_MAX_INSTANT) {
+    step = &engine->program[engine->pc];
+    switch(step->op) {
+    case AUTO_END:
+      controlDrive(0, 0);
+      indexerRequest(0);
+      engine->motion = 0;
+      return false;
+    case AUTO_FLYWHEEL:
+      flywheelSetTarget(&engine->routine->targets[step->arg]);
+      break;
+    case AUTO_INTAKE:
+      indexerRequest(step->arg > 0 ? INDEXER_LOAD : (step->arg < 0 ? INDEXER_EJECT : 0));
+      break;
+    case AUTO_DRIVE:
+      autoMotionStart(engine, step->arg, 0);
+      break;
+    case AUTO_TURN:
+      autoMotionStart(engine, abs(step->arg), step->arg > 0 ? 1 : -1);
+      break;
+    case AUTO_WAIT_DRIVE:
+      waiting = engine->motion != 0;
+      break;
+    case AUTO_WAIT_READY:
+      waiting = !flywheelReady();
+      break;
+    case AUTO_WAIT:
+      if(!engine->started) {
+        engine->waitUntil = millis() + step->arg;
+      }
+      waiting = (long)(millis() - engine->waitUntil) < 0;
+      break;
+    case AUTO_SHOOT:
+      if(!engine->started) {
+        engine->shotsUntil = flywheelShots() + step->arg;
+      }
+      waiting = step->arg == 0 || flywheelShots() - engine->shotsUntil < 0;
+      if(waiting) {
+        indexerRequest(INDEXER_FIRE);
+      } else {
+        indexerRequest(0);
+      }
+      break;
+    case AUTO_SIDE:
+      if(engine->side) {
+        engine->pc = step->arg;
+        continue;
+      }
+      break;
+    case AUTO_JUMP:
+      engine->pc = step->arg;
+      continue;
+    case AUTO_PHASE:
+      phase = &engine->routine->phases[step->arg];
+      engine->reserve = autoReserve(engine, engine->pc + 1, phase->value, false);
+      engine->reserveAll = autoReserve(engine, engine->pc + 1, 0, true);
+      engine->phaseStart = millis();
+      engine->phaseEstimate = phase->estimate;
+      if(autoRemaining(engine) < phase->estimate + engine->reserve) { //Does not fit, drop it
+        autoSkipPhase(engine);
+        continue;
+      }
+      break;
+    }
+    if(waiting && autoOutOfTime(engine)) { //Cut the phase short
+      autoSkipPhase(engine);
+      waiting = false;
+      continue;
+    }
+    if(waiting) {
+      engine->started = true;
+    } else {
+      engine->started = false;
+      engine->pc++;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,99 @@
+/** @file telemetry.c
+ * @brief File for the binary telemetry stream
+ *
+ * The sampler runs just above the driver loop so samples stay evenly spaced; the sender runs
+ * below it and is the only task that ever waits on the UART.
+ */
+
+#include "main.h"
+
+static Ring ring;
+static unsigned long samplePeriod;
+static volatile unsigned long loopTime;
+
+static uint16_t telemetryClamp(unsigned long value) {
+  return (uint16_t)(value > 0xFFFF ? 0xFFFF : value);
+}
+
+void telemetrySample(TelemetryRecord *record) {
+  unsigned int battery = powerLevelMain();
+  FlywheelCycles cycles;
+  JamCounters jams;
+
+  record->version = TELEMETRY_VERSION;
+  record->sequence = 0;
+  record->flags = (isEnabled() ? TELEMETRY_ENABLED : 0) |
+    (isAutonomous() ? TELEMETRY_AUTONOMOUS : 0) | (flywheelReady() ? TELEMETRY_READY : 0) |
+    (jamActive() ? TELEMETRY_UNJAMMING : 0);
+  record->time = millis();
+  record->targetSpeed = (int16_t)flywheelGetTarget();
+  record->speed = (int16_t)flywheelGetSpeed();
+  record->flywheel = (int8_t)motorGet(flywheelOne);
+  record->leftDrive = (int8_t)motorGet(frontLeftDrive);
+  record->rightDrive = (int8_t)motorGet(backRightDrive);
+  record->intake = (int8_t)motorGet(intake);
+  record->ballControl = (int8_t)motorGet(ballControl);
+  record->joyX = (int8_t)joystickGetAnalog(1, 1);
+  record->joyY = (int8_t)joystickGetAnalog(1, 2);
+  record->battery = telemetryClamp(battery);
+  record->loopTime = telemetryClamp(loopTime);
+  record->dropped = 0;
+  flywheelGetCycles(&cycles);
+  record->sampleCycles = telemetryClamp(cycles.sample);
+  record->stepCycles = telemetryClamp(cycles.step);
+  record->flushCycles = telemetryClamp(cycles.flush);
+  jamGetCounters(&jams);
+  record->jams = telemetryClamp(jams.jams);
+}
+
+static void telemetrySampler(void *ignore) {
+  TelemetryRecord record;
+  unsigned char frame[FRAME_SIZE(sizeof(TelemetryRecord))];
+  unsigned int length;
+  uint16_t sequence = 0;
+  uint16_t dropped = 0;
+  unsigned long wake = millis();
+
+  while(1) {
+    telemetrySample(&record);
+    record.sequence = sequence++;
+    record.dropped = dropped;
+    length = frameEncode(&record, sizeof(record), frame);
+    if(!ringWrite(&ring, frame, length)) { //Never wait on the sender, just count the loss
+      dropped++;
+    }
+    taskDelayUntil(&wake, samplePeriod);
+  }
+}
+
+static void telemetrySender(void *ignore) {
+  const unsigned char *run;
+  unsigned int length;
+
+  while(1) {
+    length = ringPeek(&ring, &run);
+    if(length > 0) {
+      fwrite(run, 1, length, uart2);
+      ringSkip(&ring, length);
+    } else {
+      delay(TELEMETRY_MIN_PERIOD / 2);
+    }
+  }
+}
+
+void telemetryInit(unsigned long period) {
+  unsigned char *buffer = arenaAlloc(ARENA_TELEMETRY, TELEMETRY_RING_SIZE);
+
+  if(!buffer) {
+    return;
+  }
+  samplePeriod = period < TELEMETRY_MIN_PERIOD ? TELEMETRY_MIN_PERIOD : period;
+  ringInit(&ring, buffer, TELEMETRY_RING_SIZE);
+  usartInit(uart2, TELEMETRY_BAUD, SERIAL_8N1);
+  taskCreate(telemetrySampler, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+  taskCreate(telemetrySender, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT - 1);
+}
+
+void telemetryLoopTime(unsigned long us) {
+  loopTime = us;
+}
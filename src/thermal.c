@@ -0,0 +1,195 @@
+/** @file thermal.c
+ * @brief File for the motor PTC thermal model and current derating
+ *
+ * A motor is a winding resistance in series with a back EMF proportional to its speed, so its
+ * current is the voltage its command puts across it less the back EMF, over the resistance.
+ * Heat is kept in 1/2^20 of the trip rise, so a fuse in equilibrium at current I settles at
+ * (I / THERMAL_HOLD)^2 of it and trips at 1.
+ */
+
+#include "main.h"
+
+//393 winding resistance in milliohms, the rated 7.2 V over the 4.8 A stall current
+#define THERMAL_RESISTANCE 1500
+//Back EMF at free speed in millivolts, the rated 7.2 V less 0.37 A free current in the winding
+#define THERMAL_EMF_FREE 6645
+//Rated voltage in millivolts that free speeds are given at
+#define THERMAL_RATED 7200
+//Flywheel free speed in counts per FLYWHEEL_WINDOW: 160 rpm geared 6:1 onto 360 counts a turn
+#define THERMAL_FLYWHEEL_FREE 115
+//Drive free speed in counts per second: 100 rpm straight onto 360 counts a turn
+#define THERMAL_DRIVE_FREE 600
+//Stall current in milliamps on a full battery, the most a limit ever needs to allow
+#define THERMAL_STALL 5400
+//Heat of a fuse at its trip temperature
+#define THERMAL_ONE (1 << 20)
+
+typedef struct {
+  unsigned char port;
+  signed char direction; //-1 if a positive shaft power is sent to the port reversed
+  ThermalShaft shaft;
+} ThermalMotor;
+
+//Every motor, with the wiring control.cpp drives them with
+static const ThermalMotor motors[] = {
+  {PORT_FLYWHEEL_ONE, 1, THERMAL_FLYWHEEL},
+  {PORT_FLYWHEEL_TWO, 1, THERMAL_FLYWHEEL},
+  {PORT_FLYWHEEL_THREE, 1, THERMAL_FLYWHEEL},
+  {PORT_FLYWHEEL_FOUR, 1, THERMAL_FLYWHEEL},
+  {PORT_FRONT_LEFT_DRIVE, 1, THERMAL_LEFT},
+  {PORT_BACK_LEFT_DRIVE, 1, THERMAL_LEFT},
+  {PORT_BACK_RIGHT_DRIVE, 1, THERMAL_RIGHT},
+  {PORT_FRONT_RIGHT_DRIVE, -1, THERMAL_RIGHT},
+  {PORT_INTAKE, 1, THERMAL_FREE},
+  {PORT_BALL_CONTROL, 1, THERMAL_FREE},
+};
+#define THERMAL_MOTORS (sizeof(motors) / sizeof(motors[0]))
+
+static volatile int heat[11];                //Per port, 1 to 10
+static volatile int low[THERMAL_SHAFTS];     //Current limit as a power range per shaft
+static volatile int high[THERMAL_SHAFTS];
+static volatile int hottest[THERMAL_SHAFTS]; //Heat of each shaft's hottest motor
+static int sustain;                          //Current in mA that settles at THERMAL_LIMIT
+
+//Integer square root, rounded down
+static int thermalSqrt(int value) {
+  int root = 0;
+  int bit = 1 << 30;
+
+  while(bit > value) {
+    bit >>= 2;
+  }
+  while(bit != 0) {
+    if(value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+//Turns a current limit into the range of shaft powers that keeps within it at a back EMF
+static void thermalRange(ThermalShaft shaft, int allowed, int emf, int battery) {
+  int drop = allowed * THERMAL_RESISTANCE / 1000;
+  int top = (emf + drop) * 127 / battery;
+  int bottom = (emf - drop) * 127 / battery;
+
+  high[shaft] = top > 127 ? 127 : (top < -127 ? -127 : top);
+  low[shaft] = bottom > 127 ? 127 : (bottom < -127 ? -127 : bottom);
+}
+
+//Drive speed in 1/1024 of free speed from the counts since last period. The autonomous
+//scripts reset the drive encoders between moves, and a reset reads as a change of speed no
+//drive can make in one period, so the speed before it is kept instead
+static int thermalDriveSpeed(Encoder encoder, int *count, int last) {
+  int now = encoderGet(encoder);
+  int speed = (now - *count) * 1024 * (1000 / THERMAL_PERIOD) / THERMAL_DRIVE_FREE;
+
+  *count = now;
+  return abs(speed - last) > 3 * 1024 / 4 ? last : speed;
+}
+
+static void thermalTask(void *ignore) {
+  unsigned long wake = millis();
+  int speed[THERMAL_SHAFTS] = {0}; //In 1/1024 of free speed
+  int predicted[THERMAL_SHAFTS];
+  int leftCount = encoderGet(left);
+  int rightCount = encoderGet(right);
+  int battery;
+  int command;
+  int emf;
+  int current;
+  int square;
+  int next;
+  int allowed;
+  unsigned int i;
+  ThermalShaft shaft;
+
+  while(1) {
+    battery = powerLevelMain();
+    speed[THERMAL_FLYWHEEL] = flywheelGetSpeed() * 1024 / THERMAL_FLYWHEEL_FREE;
+    speed[THERMAL_LEFT] = thermalDriveSpeed(left, &leftCount, speed[THERMAL_LEFT]);
+    speed[THERMAL_RIGHT] = thermalDriveSpeed(right, &rightCount, speed[THERMAL_RIGHT]);
+
+    for(shaft = 0; shaft < THERMAL_SHAFTS; shaft++) {
+      hottest[shaft] = 0;
+      predicted[shaft] = 0;
+    }
+    for(i = 0; i < THERMAL_MOTORS; i++) {
+      shaft = motors[i].shaft;
+      command = isEnabled() ? motorGet(motors[i].port) : 0;
+      if(command == 0) { //Coasting draws nothing
+        current = 0;
+      } else {
+        //An unmeasured motor turns at the free speed for the voltage it is given
+        emf = shaft == THERMAL_FREE ? command * battery / 127 * THERMAL_EMF_FREE / THERMAL_RATED :
+          motors[i].direction * THERMAL_EMF_FREE * speed[shaft] / 1024;
+        current = abs(command * battery / 127 - emf) * 1000 / THERMAL_RESISTANCE;
+      }
+      square = current * 1024 / THERMAL_HOLD;
+      square *= square;
+      next = heat[motors[i].port];
+      next += (square - next) / (THERMAL_TAU / THERMAL_PERIOD);
+      heat[motors[i].port] = next;
+      if(next > hottest[shaft]) {
+        hottest[shaft] = next;
+      }
+      next += (square - next) / (THERMAL_TAU / THERMAL_HORIZON);
+      if(next > predicted[shaft]) {
+        predicted[shaft] = next;
+      }
+    }
+
+    //The free motors have no speed to turn a current into a power, and barely load their fuses
+    for(shaft = 0; shaft < THERMAL_FREE; shaft++) {
+      if(predicted[shaft] <= THERMAL_SOFT * (THERMAL_ONE / 100) || battery < THERMAL_RATED / 2) {
+        low[shaft] = -127;
+        high[shaft] = 127;
+      } else {
+        allowed = sustain + ((THERMAL_LIMIT * (THERMAL_ONE / 100) - predicted[shaft]) >> 8) *
+          (THERMAL_STALL - sustain) / (((THERMAL_LIMIT - THERMAL_SOFT) * (THERMAL_ONE / 100)) >> 8);
+        thermalRange(shaft, allowed < 0 ? 0 : allowed, THERMAL_EMF_FREE * speed[shaft] / 1024,
+          battery);
+      }
+    }
+    taskDelayUntil(&wake, THERMAL_PERIOD);
+  }
+}
+
+void thermalInit() {
+  ThermalShaft shaft;
+
+  sustain = thermalSqrt(THERMAL_HOLD * THERMAL_HOLD / 100 * THERMAL_LIMIT);
+  for(shaft = 0; shaft < THERMAL_SHAFTS; shaft++) {
+    low[shaft] = -127;
+    high[shaft] = 127;
+  }
+  taskCreate(thermalTask, TASK_DEFAULT_STACK_SIZE, NULL, THERMAL_PRIORITY);
+}
+
+RAMFUNC int thermalApply(ThermalShaft shaft, int power) {
+  int limited;
+
+  if(power == 0) {
+    return 0;
+  }
+  limited = power > high[shaft] ? high[shaft] : (power < low[shaft] ? low[shaft] : power);
+  //A limit eases a power off but never reverses it, whatever the speed estimate says
+  return (limited > 0) == (power > 0) ? limited : 0;
+}
+
+int thermalHeadroom(ThermalShaft shaft) {
+  int used = (hottest[shaft] >> 10) * 100 >> 10;
+
+  return used > 100 ? 0 : 100 - used;
+}
+
+int thermalTemperature(unsigned char port) {
+  if(port < 1 || port > 10) {
+    return THERMAL_AMBIENT;
+  }
+  return THERMAL_AMBIENT + ((heat[port] >> 10) * (THERMAL_TRIP - THERMAL_AMBIENT) >> 10);
+}